@@ -0,0 +1,455 @@
+// AsyncQueue.hpp
+// A queue for C++20 coroutines, built on top of a DoublyLinkedList.
+//
+// Instead of polling isEmpty() and calling first() and removeFromStart(),
+// a coroutine can write
+//
+//     ValueType value = co_await queue.pop();
+//
+// and will be suspended until a value is available.  When addToEnd() is
+// called while coroutines are waiting, the value is handed directly to
+// the coroutine that has been waiting longest, so no other consumer can
+// take it first, and that coroutine is resumed.
+//
+// The queue doesn't know anything about the event loop it runs in.  It
+// resumes coroutines through a scheduling function given to it when it
+// is constructed, which should arrange for the coroutine to be resumed
+// (for example, by posting it to the event loop).  Without one, waiting
+// coroutines are resumed immediately, inside the call to addToEnd().
+// LocalScheduler.hpp has a small single-threaded scheduler for tests.
+//
+// The queue is meant to be used from a single thread, like the event loop
+// it belongs to, and is not safe to share between threads.  A coroutine
+// that is destroyed while it is suspended waiting on the queue stops
+// waiting.  The queue doesn't own the coroutines waiting on it: if it is
+// destroyed while some are, they are left suspended, for whatever owns
+// them (a LocalScheduler, for LocalTasks) to destroy.
+//
+// Once close() has been called, addToEnd() throws a ClosedException, and
+// popping keeps returning the remaining values until the queue is empty,
+// after which it throws a ClosedException too (including in coroutines
+// that were already waiting).
+
+
+#ifndef ASYNCQUEUE_HPP
+#define ASYNCQUEUE_HPP
+
+#include <coroutine>
+#include <functional>
+#include <utility>
+#include "ClosedException.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+template <typename ValueType>
+class AsyncQueue
+{
+public:
+    // A function that arranges for a suspended coroutine to be resumed.
+    using Scheduler = std::function<void(std::coroutine_handle<>)>;
+
+    class PopAwaitable;
+    class PopBatchAwaitable;
+
+
+    // Initializes this queue to be empty and open, resuming waiting
+    // coroutines through the given scheduler (or immediately, without one).
+    explicit AsyncQueue(Scheduler scheduler = Scheduler{});
+
+
+    // Waiting coroutines hold on to the queue they are waiting on, so it
+    // can neither be copied nor moved.
+    AsyncQueue(const AsyncQueue& queue) = delete;
+    AsyncQueue& operator=(const AsyncQueue& queue) = delete;
+
+
+    // Leaves any coroutines still waiting suspended, no longer waiting on
+    // anything.
+    ~AsyncQueue();
+
+
+    // addToEnd() adds a value to the end of the queue, or, if coroutines
+    // are waiting, hands it to the one that has waited longest and
+    // schedules it to resume.  If the queue is closed, a ClosedException
+    // will be thrown.
+    void addToEnd(const ValueType& value);
+
+
+    // pop() returns an awaitable that removes the value at the start of the
+    // queue and produces it, suspending the awaiting coroutine until there
+    // is one.
+    PopAwaitable pop() noexcept;
+
+    // popBatch() returns an awaitable that suspends until there is at least
+    // one value, then removes up to maxCount values from the start of the
+    // queue and produces them as a DoublyLinkedList.
+    PopBatchAwaitable popBatch(unsigned int maxCount) noexcept;
+
+
+    // close() closes the queue, scheduling every waiting coroutine to
+    // resume with a ClosedException.  Closing a closed queue has no effect.
+    void close();
+
+
+    // isClosed() returns true if close() has been called, false otherwise.
+    bool isClosed() const noexcept;
+
+    // isEmpty() returns true if the queue has no values in it, false
+    // otherwise.
+    bool isEmpty() const noexcept;
+
+    // size() returns the number of values in the queue.
+    unsigned int size() const noexcept;
+
+    // waitingCount() returns the number of coroutines waiting for a value.
+    unsigned int waitingCount() const noexcept;
+
+
+private:
+    // A suspended coroutine, along with the values that have been handed
+    // to it, how many it will take, and whether it is still in the line.
+    struct Waiter
+    {
+        std::coroutine_handle<> handle;
+        DoublyLinkedList<ValueType> received;
+        unsigned int maxCount;
+        bool waiting;
+    };
+
+
+    // Whether an awaiting coroutine can carry on without suspending.
+    bool canPopWithoutWaiting() const noexcept;
+
+    // Adds a waiter to the back of the line.
+    void wait(Waiter& waiter);
+
+    // Takes a waiter out of the line, wherever it is.
+    void stopWaiting(Waiter& waiter);
+
+    // Resumes the coroutine through the scheduler, or directly without one.
+    void resume(std::coroutine_handle<> handle);
+
+    // Moves up to maxCount values (beyond those it already has) from the
+    // start of the queue into the waiter's received values.
+    void takeValues(Waiter& waiter);
+
+
+    DoublyLinkedList<ValueType> values;
+    DoublyLinkedList<Waiter*> waiters;
+    Scheduler scheduler;
+    bool closed;
+
+
+public:
+    class PopAwaitable
+    {
+    public:
+        explicit PopAwaitable(AsyncQueue& queue) noexcept;
+
+        // Stops waiting, if the coroutine is destroyed while it is.
+        ~PopAwaitable();
+
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle);
+        ValueType await_resume();
+
+    private:
+        AsyncQueue* queue;
+        Waiter waiter;
+    };
+
+
+    class PopBatchAwaitable
+    {
+    public:
+        PopBatchAwaitable(AsyncQueue& queue, unsigned int maxCount) noexcept;
+
+        // Stops waiting, if the coroutine is destroyed while it is.
+        ~PopBatchAwaitable();
+
+        bool await_ready() const noexcept;
+        void await_suspend(std::coroutine_handle<> handle);
+        DoublyLinkedList<ValueType> await_resume();
+
+    private:
+        AsyncQueue* queue;
+        Waiter waiter;
+    };
+};
+
+
+
+// Constructor
+template <typename ValueType>
+AsyncQueue<ValueType>::AsyncQueue(Scheduler scheduler)
+    : values{}, waiters{}, scheduler{std::move(scheduler)}, closed{false}
+{
+}
+
+
+// Destructor
+template <typename ValueType>
+AsyncQueue<ValueType>::~AsyncQueue()
+{
+    waiters.forEach([](Waiter* waiter)
+    {
+        waiter->waiting = false;
+    });
+}
+
+
+// Hands the value straight to the longest waiter if there is one, otherwise queues it.
+template <typename ValueType>
+void AsyncQueue<ValueType>::addToEnd(const ValueType& value)
+{
+    if (closed)
+    {
+        throw ClosedException{};
+    }
+
+    if (waiters.isEmpty())
+    {
+        values.addToEnd(value);
+    }
+    else
+    {
+        // Copy the value over before giving up the waiter, in case copying throws.
+        Waiter* waiter = waiters.first();
+        waiter->received.addToEnd(value);
+        waiters.removeFromStart();
+        waiter->waiting = false;
+
+        resume(waiter->handle);
+    }
+}
+
+
+template <typename ValueType>
+typename AsyncQueue<ValueType>::PopAwaitable AsyncQueue<ValueType>::pop() noexcept
+{
+    return PopAwaitable{*this};
+}
+
+
+template <typename ValueType>
+typename AsyncQueue<ValueType>::PopBatchAwaitable AsyncQueue<ValueType>::popBatch(unsigned int maxCount) noexcept
+{
+    return PopBatchAwaitable{*this, maxCount};
+}
+
+
+// Wakes every waiter empty-handed so it throws when it resumes.
+template <typename ValueType>
+void AsyncQueue<ValueType>::close()
+{
+    closed = true;
+
+    while (waiters.isEmpty() == false)
+    {
+        Waiter* waiter = waiters.first();
+        waiters.removeFromStart();
+        waiter->waiting = false;
+
+        resume(waiter->handle);
+    }
+}
+
+
+template <typename ValueType>
+bool AsyncQueue<ValueType>::isClosed() const noexcept
+{
+    return closed;
+}
+
+
+template <typename ValueType>
+bool AsyncQueue<ValueType>::isEmpty() const noexcept
+{
+    return values.isEmpty();
+}
+
+
+template <typename ValueType>
+unsigned int AsyncQueue<ValueType>::size() const noexcept
+{
+    return values.size();
+}
+
+
+template <typename ValueType>
+unsigned int AsyncQueue<ValueType>::waitingCount() const noexcept
+{
+    return waiters.size();
+}
+
+
+// A coroutine only skips the line when nobody is waiting and there's a value (or the queue is done).
+template <typename ValueType>
+bool AsyncQueue<ValueType>::canPopWithoutWaiting() const noexcept
+{
+    return waiters.isEmpty() && (values.isEmpty() == false || closed);
+}
+
+
+template <typename ValueType>
+void AsyncQueue<ValueType>::wait(Waiter& waiter)
+{
+    waiters.addToEnd(&waiter);
+    waiter.waiting = true;
+}
+
+
+// Only a coroutine destroyed while waiting leaves the line this way, so a linear search will do.
+template <typename ValueType>
+void AsyncQueue<ValueType>::stopWaiting(Waiter& waiter)
+{
+    for (typename DoublyLinkedList<Waiter*>::Iterator iterator = waiters.iterator(); iterator.isPastEnd() == false; iterator.moveToNext())
+    {
+        if (iterator.value() == &waiter)
+        {
+            iterator.remove();
+            break;
+        }
+    }
+
+    waiter.waiting = false;
+}
+
+
+template <typename ValueType>
+void AsyncQueue<ValueType>::resume(std::coroutine_handle<> handle)
+{
+    if (scheduler)
+    {
+        scheduler(handle);
+    }
+    else
+    {
+        handle.resume();
+    }
+}
+
+
+template <typename ValueType>
+void AsyncQueue<ValueType>::takeValues(Waiter& waiter)
+{
+    while (waiter.received.size() < waiter.maxCount && values.isEmpty() == false)
+    {
+        waiter.received.addToEnd(values.first());
+        values.removeFromStart();
+    }
+}
+
+
+
+//
+// PopAwaitable member functions //
+//
+
+
+template <typename ValueType>
+AsyncQueue<ValueType>::PopAwaitable::PopAwaitable(AsyncQueue& queue) noexcept
+    : queue{&queue}, waiter{nullptr, DoublyLinkedList<ValueType>{}, 1, false}
+{
+}
+
+
+// Destructor
+template <typename ValueType>
+AsyncQueue<ValueType>::PopAwaitable::~PopAwaitable()
+{
+    if (waiter.waiting == true)
+    {
+        queue->stopWaiting(waiter);
+    }
+}
+
+
+template <typename ValueType>
+bool AsyncQueue<ValueType>::PopAwaitable::await_ready() const noexcept
+{
+    return queue->canPopWithoutWaiting();
+}
+
+
+template <typename ValueType>
+void AsyncQueue<ValueType>::PopAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    waiter.handle = handle;
+    queue->wait(waiter);
+}
+
+
+// Produces the value handed over while waiting, or takes one if there was no wait.
+template <typename ValueType>
+ValueType AsyncQueue<ValueType>::PopAwaitable::await_resume()
+{
+    queue->takeValues(waiter);
+
+    if (waiter.received.isEmpty())
+    {
+        throw ClosedException{};
+    }
+
+    return std::move(waiter.received.first());
+}
+
+
+
+//
+// PopBatchAwaitable member functions //
+//
+
+
+template <typename ValueType>
+AsyncQueue<ValueType>::PopBatchAwaitable::PopBatchAwaitable(AsyncQueue& queue, unsigned int maxCount) noexcept
+    : queue{&queue}, waiter{nullptr, DoublyLinkedList<ValueType>{}, maxCount == 0 ? 1 : maxCount, false}
+{
+}
+
+
+// Destructor
+template <typename ValueType>
+AsyncQueue<ValueType>::PopBatchAwaitable::~PopBatchAwaitable()
+{
+    if (waiter.waiting == true)
+    {
+        queue->stopWaiting(waiter);
+    }
+}
+
+
+template <typename ValueType>
+bool AsyncQueue<ValueType>::PopBatchAwaitable::await_ready() const noexcept
+{
+    return queue->canPopWithoutWaiting();
+}
+
+
+template <typename ValueType>
+void AsyncQueue<ValueType>::PopBatchAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    waiter.handle = handle;
+    queue->wait(waiter);
+}
+
+
+// Produces the value handed over while waiting (if any) topped up from the queue.
+template <typename ValueType>
+DoublyLinkedList<ValueType> AsyncQueue<ValueType>::PopBatchAwaitable::await_resume()
+{
+    queue->takeValues(waiter);
+
+    if (waiter.received.isEmpty())
+    {
+        throw ClosedException{};
+    }
+
+    return std::move(waiter.received);
+}
+
+
+
+#endif
+
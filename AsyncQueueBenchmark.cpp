@@ -0,0 +1,153 @@
+// AsyncQueueBenchmark.cpp
+// Compares the handoff latency of an AsyncQueue between two coroutines
+// with that of a condition-variable queue (BoundedQueue) between two
+// threads.
+//
+//     g++ -std=c++20 -O2 -pthread AsyncQueueBenchmark.cpp -o AsyncQueueBenchmark
+//     ./AsyncQueueBenchmark [round trips, default 200000]
+//
+// Each side ping-pongs a value through a pair of queues: one side pushes a
+// value and waits for it to come back on the other queue, and the other
+// side sends back whatever it receives.  Every round trip is two
+// handoffs, and its time is recorded; the p50 and p99 are reported.  The
+// coroutines are run by a LocalScheduler on one thread, and also with no
+// scheduler, which resumes a waiting coroutine inside addToEnd().
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "AsyncQueue.hpp"
+#include "BenchmarkUtil.hpp"
+#include "BoundedQueue.hpp"
+#include "LocalScheduler.hpp"
+
+
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+
+    LocalTask pinger(AsyncQueue<long>& ping, AsyncQueue<long>& pong, unsigned int rounds, std::vector<std::int64_t>& roundTrips)
+    {
+        for (unsigned int round = 0; round < rounds; round++)
+        {
+            Clock::time_point start = Clock::now();
+
+            ping.addToEnd(round);
+            co_await pong.pop();
+
+            roundTrips.push_back(nanosecondsSince(start));
+        }
+
+        ping.close();
+    }
+
+
+    LocalTask ponger(AsyncQueue<long>& ping, AsyncQueue<long>& pong)
+    {
+        try
+        {
+            for (;;)
+            {
+                long value = co_await ping.pop();
+                pong.addToEnd(value);
+            }
+        }
+        // The pinger has finished.
+        catch(ClosedException&)
+        {
+        }
+    }
+
+
+    std::vector<std::int64_t> coroutineRoundTrips(unsigned int rounds, bool useScheduler)
+    {
+        std::vector<std::int64_t> roundTrips;
+        roundTrips.reserve(rounds);
+
+        LocalScheduler scheduler;
+        AsyncQueue<long>::Scheduler schedule;
+
+        if (useScheduler == true)
+        {
+            schedule = [&scheduler](std::coroutine_handle<> handle) { scheduler.schedule(handle); };
+        }
+
+        AsyncQueue<long> ping{schedule};
+        AsyncQueue<long> pong{schedule};
+
+        scheduler.spawn(ponger(ping, pong));
+        scheduler.spawn(pinger(ping, pong, rounds, roundTrips));
+        scheduler.run();
+
+        return roundTrips;
+    }
+
+
+    std::vector<std::int64_t> threadRoundTrips(unsigned int rounds)
+    {
+        std::vector<std::int64_t> roundTrips;
+        roundTrips.reserve(rounds);
+
+        BoundedQueue<long> ping{1024};
+        BoundedQueue<long> pong{1024};
+
+        std::thread echo{[&ping, &pong]
+        {
+            try
+            {
+                for (;;)
+                {
+                    pong.push(ping.pop());
+                }
+            }
+            // The pinging thread has finished.
+            catch(ClosedException&)
+            {
+            }
+        }};
+
+        for (unsigned int round = 0; round < rounds; round++)
+        {
+            Clock::time_point start = Clock::now();
+
+            ping.push(round);
+            pong.pop();
+
+            roundTrips.push_back(nanosecondsSince(start));
+        }
+
+        ping.close();
+        echo.join();
+
+        return roundTrips;
+    }
+
+
+    void report(const char* name, std::vector<std::int64_t> roundTrips)
+    {
+        std::sort(roundTrips.begin(), roundTrips.end());
+
+        std::printf("%-34s round trip p50 %9.0f ns   p99 %9.0f ns\n", name, percentile(roundTrips, 0.50), percentile(roundTrips, 0.99));
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned int rounds = static_cast<unsigned int>(argumentOr(argc, argv, 1, 200000));
+
+    std::printf("%u round trips, %u hardware threads\n", rounds, std::thread::hardware_concurrency());
+
+    report("AsyncQueue, LocalScheduler", coroutineRoundTrips(rounds, true));
+    report("AsyncQueue, resumed in addToEnd()", coroutineRoundTrips(rounds, false));
+    report("BoundedQueue, two threads", threadRoundTrips(rounds));
+
+    return 0;
+}
@@ -0,0 +1,315 @@
+// AsyncQueueTest.cpp
+// Checks AsyncQueue and LocalScheduler: that values go to waiting
+// coroutines in the order they started waiting, that a coroutine popping
+// from a queue that has values carries on without suspending, that
+// coroutines woken through a LocalScheduler are resumed by run() in the
+// order they were woken (and not before), that closing the queue wakes
+// waiters with a ClosedException, and that no coroutine frame is leaked
+// when a task is never spawned, or when the scheduler or the queue is
+// destroyed while tasks are still scheduled or waiting.
+//
+//     g++ -std=c++20 -g -fsanitize=address,undefined AsyncQueueTest.cpp -o AsyncQueueTest
+//     ./AsyncQueueTest
+//
+// The program prints each check as it passes, and aborts on the first one
+// that fails.
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "AsyncQueue.hpp"
+#include "LocalScheduler.hpp"
+
+
+
+namespace
+{
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "AsyncQueueTest: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    // The number of coroutine frames alive.  Each task takes a Frame by
+    // value, whose copy lives in the coroutine's frame from the call until
+    // the frame is destroyed.
+    int framesAlive = 0;
+
+    struct Frame
+    {
+        Frame() noexcept
+        {
+            framesAlive++;
+        }
+
+        Frame(const Frame&) noexcept
+        {
+            framesAlive++;
+        }
+
+        ~Frame()
+        {
+            framesAlive--;
+        }
+    };
+
+
+    // Pops count values, logging each one as "name:value".
+    LocalTask consumer(Frame, AsyncQueue<int>& queue, std::string name, int count, std::vector<std::string>& log)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int value = co_await queue.pop();
+            log.push_back(name + ":" + std::to_string(value));
+        }
+    }
+
+
+    // Pops until the queue is closed, logging "name:closed".
+    LocalTask closedConsumer(Frame, AsyncQueue<int>& queue, std::string name, std::vector<std::string>& log)
+    {
+        try
+        {
+            for (;;)
+            {
+                co_await queue.pop();
+            }
+        }
+        catch(ClosedException&)
+        {
+            log.push_back(name + ":closed");
+        }
+    }
+
+
+    LocalTask producer(Frame, AsyncQueue<int>& queue, int first, int count, std::vector<std::string>& log)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            log.push_back("add:" + std::to_string(first + i));
+            queue.addToEnd(first + i);
+        }
+
+        co_return;
+    }
+
+
+    bool logIs(const std::vector<std::string>& log, const std::vector<std::string>& expected)
+    {
+        return log == expected;
+    }
+
+
+    // Values added while coroutines wait go to them in the order they
+    // started waiting, without passing through the queue.
+    void checkHandoffOrder()
+    {
+        std::vector<std::string> log;
+        LocalScheduler scheduler;
+        AsyncQueue<int> queue{[&scheduler](std::coroutine_handle<> handle) { scheduler.schedule(handle); }};
+
+        scheduler.spawn(consumer(Frame{}, queue, "a", 1, log));
+        scheduler.spawn(consumer(Frame{}, queue, "b", 1, log));
+        scheduler.spawn(consumer(Frame{}, queue, "c", 1, log));
+        scheduler.run();
+        require(queue.waitingCount() == 3 && log.empty(), "consumers didn't wait on an empty queue");
+
+        queue.addToEnd(1);
+        queue.addToEnd(2);
+        queue.addToEnd(3);
+        require(queue.isEmpty() == true && queue.waitingCount() == 0, "values weren't handed straight to the waiters");
+
+        scheduler.run();
+        require(logIs(log, {"a:1", "b:2", "c:3"}), "waiters didn't get values in the order they waited");
+        require(scheduler.taskCount() == 0 && framesAlive == 0, "finished tasks weren't destroyed");
+
+        std::printf("handoff to waiters in order: passed\n");
+    }
+
+
+    // A coroutine popping from a queue that has values never suspends, so
+    // it never goes through the scheduler.
+    void checkImmediatePop()
+    {
+        std::vector<std::string> log;
+        LocalScheduler scheduler;
+        int scheduled = 0;
+        AsyncQueue<int> queue{[&scheduler, &scheduled](std::coroutine_handle<> handle)
+        {
+            scheduled++;
+            scheduler.schedule(handle);
+        }};
+
+        queue.addToEnd(1);
+        queue.addToEnd(2);
+        queue.addToEnd(3);
+
+        scheduler.spawn(consumer(Frame{}, queue, "a", 3, log));
+        scheduler.run();
+
+        require(logIs(log, {"a:1", "a:2", "a:3"}), "queued values weren't popped in order");
+        require(scheduled == 0 && queue.isEmpty() == true, "a pop with values queued suspended");
+        require(framesAlive == 0, "finished task wasn't destroyed");
+
+        std::printf("immediate pop of queued values: passed\n");
+    }
+
+
+    // Waking a coroutine through the scheduler only schedules it; run()
+    // resumes it later, after the producer, in the order the waiters were
+    // woken.
+    void checkResumeOrder()
+    {
+        std::vector<std::string> log;
+        LocalScheduler scheduler;
+        AsyncQueue<int> queue{[&scheduler](std::coroutine_handle<> handle) { scheduler.schedule(handle); }};
+
+        scheduler.spawn(consumer(Frame{}, queue, "a", 2, log));
+        scheduler.spawn(consumer(Frame{}, queue, "b", 2, log));
+        scheduler.spawn(producer(Frame{}, queue, 1, 3, log));
+        scheduler.run();
+
+        // a and b are each handed one value and scheduled, and the third is queued.  a resumes first and
+        // takes the queued value without waiting, then b resumes and is left waiting for its second.
+        require(logIs(log, {"add:1", "add:2", "add:3", "a:1", "a:3", "b:2"}), "woken coroutines ran in the wrong order");
+        require(queue.waitingCount() == 1 && scheduler.taskCount() == 1, "b isn't the one left waiting");
+
+        queue.addToEnd(4);
+        require(log.size() == 6, "a waiter was resumed inside addToEnd()");
+        scheduler.run();
+        require(log.back() == "b:4" && scheduler.taskCount() == 0 && framesAlive == 0, "b didn't get the last value");
+
+        std::printf("resume order through the scheduler: passed\n");
+    }
+
+
+    // Without a scheduler, addToEnd() resumes the waiter straight away.
+    void checkResumeWithoutScheduler()
+    {
+        std::vector<std::string> log;
+        LocalScheduler scheduler;
+        AsyncQueue<int> queue;
+
+        scheduler.spawn(consumer(Frame{}, queue, "a", 1, log));
+        scheduler.run();
+
+        queue.addToEnd(7);
+        require(logIs(log, {"a:7"}) && scheduler.isIdle() == true, "waiter wasn't resumed inside addToEnd()");
+        require(framesAlive == 0, "finished task wasn't destroyed");
+
+        std::printf("resume without a scheduler: passed\n");
+    }
+
+
+    void checkClose()
+    {
+        std::vector<std::string> log;
+        LocalScheduler scheduler;
+        AsyncQueue<int> queue{[&scheduler](std::coroutine_handle<> handle) { scheduler.schedule(handle); }};
+
+        scheduler.spawn(closedConsumer(Frame{}, queue, "a", log));
+        scheduler.spawn(closedConsumer(Frame{}, queue, "b", log));
+        scheduler.run();
+
+        queue.close();
+        scheduler.run();
+        require(logIs(log, {"a:closed", "b:closed"}), "waiters weren't woken by close()");
+        require(framesAlive == 0, "closed tasks weren't destroyed");
+
+        bool thrown = false;
+        try
+        {
+            queue.addToEnd(1);
+        }
+        catch(ClosedException&)
+        {
+            thrown = true;
+        }
+        require(thrown, "addToEnd() on a closed queue didn't throw");
+
+        std::printf("close wakes waiters: passed\n");
+    }
+
+
+    // Every way a task can be abandoned must still destroy its frame.
+    void checkNoFramesLeaked()
+    {
+        std::vector<std::string> log;
+
+        {
+            AsyncQueue<int> queue;
+            LocalTask task = consumer(Frame{}, queue, "never spawned", 1, log);
+            LocalTask moved{std::move(task)};
+            require(framesAlive == 1, "a task's frame wasn't created");
+        }
+        require(framesAlive == 0, "a task that was never spawned leaked its frame");
+
+        {
+            AsyncQueue<int> queue;
+            LocalScheduler scheduler;
+
+            scheduler.spawn(consumer(Frame{}, queue, "never run", 1, log));
+            require(scheduler.taskCount() == 1, "a spawned task isn't counted");
+        }
+        require(framesAlive == 0, "a task scheduled but never run leaked its frame");
+
+        {
+            AsyncQueue<int> queue;
+            LocalScheduler scheduler;
+
+            scheduler.spawn(consumer(Frame{}, queue, "waiting", 1, log));
+            scheduler.spawn(consumer(Frame{}, queue, "also waiting", 1, log));
+            scheduler.run();
+            require(queue.waitingCount() == 2, "tasks aren't waiting");
+
+            // The queue outlives the tasks, so destroying them has to take them out of its line.
+            scheduler.clear();
+            require(framesAlive == 0 && scheduler.taskCount() == 0, "clear() leaked a waiting task's frame");
+            require(queue.waitingCount() == 0, "a destroyed task is still waiting");
+
+            queue.addToEnd(1);
+            require(queue.size() == 1, "a value was handed to a destroyed task");
+        }
+
+        {
+            LocalScheduler scheduler;
+
+            {
+                AsyncQueue<int> queue{[&scheduler](std::coroutine_handle<> handle) { scheduler.schedule(handle); }};
+
+                scheduler.spawn(consumer(Frame{}, queue, "queue destroyed", 1, log));
+                scheduler.spawn(consumer(Frame{}, queue, "also queue destroyed", 1, log));
+                scheduler.run();
+                require(queue.waitingCount() == 2, "tasks aren't waiting");
+            }
+
+            // The queue doesn't own its waiters, and mustn't be touched by them once it is gone.
+            require(framesAlive == 2 && scheduler.taskCount() == 2, "tasks were destroyed with the queue");
+        }
+        require(framesAlive == 0, "tasks whose queue was destroyed leaked their frames");
+
+        require(log.empty(), "an abandoned task ran");
+
+        std::printf("no frames leaked: passed\n");
+    }
+}
+
+
+
+int main()
+{
+    checkHandoffOrder();
+    checkImmediatePop();
+    checkResumeOrder();
+    checkResumeWithoutScheduler();
+    checkClose();
+    checkNoFramesLeaked();
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+// BenchmarkUtil.hpp
+// Timing, threading and reporting helpers shared by the *Benchmark.cpp
+// programs, so that each of them only has to say what it measures.
+
+
+#ifndef BENCHMARKUTIL_HPP
+#define BENCHMARKUTIL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+
+
+// secondsSince() returns how many seconds have passed since the given
+// time.
+inline double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// nanosecondsSince() returns how many nanoseconds have passed since the
+// given time, for recording one latency.
+inline std::int64_t nanosecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+// bestOf() calls the given function the given number of times and returns
+// the shortest time any one call took, in seconds.  Taking the best run
+// rather than the average keeps a stray page fault or context switch from
+// counting against what is being measured.
+template <typename Function>
+double bestOf(int runs, Function function)
+{
+    double best = 0.0;
+
+    for (int run = 0; run < runs; run++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        function();
+        double seconds = secondsSince(start);
+
+        best = (run == 0 || seconds < best) ? seconds : best;
+    }
+
+    return best;
+}
+
+
+// inParallel() calls the given function on threadCount threads at once,
+// passing each one its index (from 0), and returns the seconds from the
+// first thread starting to the last one finishing.
+template <typename Function>
+double inParallel(unsigned int threadCount, Function function)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 0; thread < threadCount; thread++)
+    {
+        threads.emplace_back(function, thread);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    return secondsSince(start);
+}
+
+
+// percentile() returns the value at the given fraction of the way through
+// a sorted vector (0.5 for the median, 0.99 for the p99), or 0 if the
+// vector is empty.
+inline double percentile(const std::vector<std::int64_t>& sorted, double fraction)
+{
+    if (sorted.empty() == true)
+    {
+        return 0.0;
+    }
+
+    return static_cast<double>(sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))]);
+}
+
+
+// buildScattered() adds the values 0 to values - 1, in order, to the end
+// of the given list, with its nodes scattered around memory the way they
+// are in a long-lived program.  The values are added to the ends of 4096
+// smaller lists in random order, and those lists are then spliced
+// together, so that each node was allocated far from its neighbours.
+template <typename List>
+void buildScattered(List& list, unsigned long values)
+{
+    std::vector<List> pieces(4096);
+    std::mt19937 random{1};
+
+    for (unsigned long i = 0; i < values; i++)
+    {
+        pieces[random() % pieces.size()].addToEnd(static_cast<long>(i));
+    }
+
+    for (List& piece : pieces)
+    {
+        list.spliceToEnd(piece);
+    }
+}
+
+
+// argumentOr() returns the command-line argument at the given index as a
+// number, or the given default if there aren't that many arguments.
+inline unsigned long argumentOr(int argc, char** argv, int index, unsigned long defaultValue)
+{
+    return (argc > index) ? std::strtoul(argv[index], nullptr, 10) : defaultValue;
+}
+
+
+
+#endif
+
@@ -0,0 +1,453 @@
+// BoundedQueue.hpp
+// A blocking, bounded producer/consumer queue built on top of a
+// DoublyLinkedList, a mutex and two condition variables.
+//
+// Producers block once the queue holds highWatermark values and stay
+// blocked until consumers have drained it down to lowWatermark values,
+// so a busy queue wakes its producers in bursts instead of once per pop.
+// Waiting threads can optionally spin for a while before they park on a
+// condition variable, which cuts handoff latency when the other side is
+// about to act anyway.
+//
+// Once close() has been called, pushing throws a ClosedException, and
+// popping keeps returning the remaining values until the queue is empty,
+// after which it throws a ClosedException too.
+
+
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "ClosedException.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+template <typename ValueType>
+class BoundedQueue
+{
+public:
+    // Initializes this queue to be empty and open, blocking producers once
+    // it holds capacity values and releasing them as soon as there is room
+    // for one more.
+    explicit BoundedQueue(unsigned int capacity);
+
+    // Initializes this queue to be empty and open, blocking producers once
+    // it holds highWatermark values and releasing them once it is back down
+    // to lowWatermark values.  A waiting thread re-checks the queue up to
+    // spinCount times before it parks.
+    BoundedQueue(unsigned int highWatermark, unsigned int lowWatermark, unsigned int spinCount = 0);
+
+
+    // A queue is shared between threads by reference, so it can neither be
+    // copied nor moved.
+    BoundedQueue(const BoundedQueue& queue) = delete;
+    BoundedQueue& operator=(const BoundedQueue& queue) = delete;
+
+
+    // push() adds a value to the end of the queue, waiting until producers
+    // are allowed to add to it.  If the queue is closed (before or while
+    // waiting), a ClosedException will be thrown.
+    void push(const ValueType& value);
+
+    // tryPush() is like push(), except that it gives up and returns false
+    // if the value could not be added within the given timeout.  It returns
+    // true if the value was added.
+    template <typename Rep, typename Period>
+    bool tryPush(const ValueType& value, const std::chrono::duration<Rep, Period>& timeout);
+
+    // pushBatch() adds every value in the given list to the end of the
+    // queue in order, waiting whenever producers are held back.  Values
+    // are moved by relinking their nodes, as many at a time as there is
+    // room for, so nothing is copied or allocated while the lock is held.
+    // Values that were added are gone from the front of the list, so if a
+    // ClosedException is thrown, the list holds exactly the ones that
+    // weren't.
+    void pushBatch(DoublyLinkedList<ValueType>& values);
+
+
+    // pop() removes the value at the start of the queue and returns it,
+    // waiting until there is one.  If the queue is closed and empty (before
+    // or while waiting), a ClosedException will be thrown.
+    ValueType pop();
+
+    // tryPop() is like pop(), except that the value is stored into the
+    // given one, and it gives up and returns false if no value arrived
+    // within the given timeout.  It returns true if a value was removed.
+    template <typename Rep, typename Period>
+    bool tryPop(ValueType& value, const std::chrono::duration<Rep, Period>& timeout);
+
+    // popBatch() waits until there is at least one value in the queue, then
+    // removes and returns up to maxCount values from its start, in order.
+    // The values' nodes are relinked into the returned list, so nothing is
+    // copied or allocated, and once values have been taken from the queue
+    // nothing can throw before they are returned.  If the queue is closed
+    // and empty, a ClosedException will be thrown.
+    DoublyLinkedList<ValueType> popBatch(unsigned int maxCount);
+
+
+    // close() closes the queue and wakes every waiting thread.  Closing a
+    // queue that is already closed has no effect.
+    void close() noexcept;
+
+
+    // isClosed() returns true if close() has been called, false otherwise.
+    bool isClosed() const noexcept;
+
+
+    // size() returns the number of values in the queue at the moment it
+    // was called.
+    unsigned int size() const noexcept;
+
+
+private:
+    // Spins for up to spinCount checks until the condition is true, without
+    // holding the mutex.  Returns true if the condition became true.
+    template <typename Condition>
+    bool spinUntil(Condition condition) const noexcept;
+
+    // Whether producers may currently add a value.  The mutex must be held.
+    bool canPush() const noexcept;
+
+    // Adds one value and wakes a consumer if one is waiting.  The mutex must be held.
+    void addLocked(const ValueType& value);
+
+    // Removes the first value and wakes producers if the queue has drained
+    // down to the low watermark.  The mutex must be held.
+    ValueType removeLocked();
+
+
+    DoublyLinkedList<ValueType> list;
+    unsigned int highWatermark;
+    unsigned int lowWatermark;
+    unsigned int spinCount;
+
+    // Set when the queue reaches the high watermark and cleared once it
+    // drains to the low watermark; producers wait while it is set.
+    bool throttled;
+
+    // Mirrors list.size() and the closed state so spinning threads can
+    // watch them without taking the mutex.
+    std::atomic<unsigned int> count;
+    std::atomic<bool> closed;
+
+    // How many threads are parked on each condition variable, so the other
+    // side only pays for a notification when someone is listening.
+    unsigned int waitingProducers;
+    unsigned int waitingConsumers;
+
+    mutable std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+};
+
+
+// Constructor with a single capacity.
+template <typename ValueType>
+BoundedQueue<ValueType>::BoundedQueue(unsigned int capacity)
+    : BoundedQueue{capacity, capacity == 0 ? 0 : capacity - 1}
+{
+}
+
+
+// Constructor with both watermarks.
+template <typename ValueType>
+BoundedQueue<ValueType>::BoundedQueue(unsigned int highWatermark, unsigned int lowWatermark, unsigned int spinCount)
+    : highWatermark{highWatermark == 0 ? 1 : highWatermark},
+      lowWatermark{lowWatermark},
+      spinCount{spinCount},
+      throttled{false},
+      count{0},
+      closed{false},
+      waitingProducers{0},
+      waitingConsumers{0}
+{
+    // The low watermark must be below the high one or producers would never be released.
+    if (this->lowWatermark >= this->highWatermark)
+    {
+        this->lowWatermark = this->highWatermark - 1;
+    }
+}
+
+
+// Adds to the end, blocking while producers are held back.
+template <typename ValueType>
+void BoundedQueue<ValueType>::push(const ValueType& value)
+{
+    spinUntil([this]() { return count.load(std::memory_order_relaxed) < highWatermark || closed.load(std::memory_order_relaxed); });
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    waitingProducers++;
+    notFull.wait(lock, [this]() { return canPush() || closed.load(std::memory_order_relaxed); });
+    waitingProducers--;
+
+    if (closed.load(std::memory_order_relaxed))
+    {
+        throw ClosedException{};
+    }
+
+    addLocked(value);
+}
+
+
+// Adds to the end, blocking while producers are held back, but no longer than timeout.
+template <typename ValueType>
+template <typename Rep, typename Period>
+bool BoundedQueue<ValueType>::tryPush(const ValueType& value, const std::chrono::duration<Rep, Period>& timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    spinUntil([this]() { return count.load(std::memory_order_relaxed) < highWatermark || closed.load(std::memory_order_relaxed); });
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    waitingProducers++;
+    bool ready = notFull.wait_until(lock, deadline, [this]() { return canPush() || closed.load(std::memory_order_relaxed); });
+    waitingProducers--;
+
+    if (closed.load(std::memory_order_relaxed))
+    {
+        throw ClosedException{};
+    }
+    else if (ready == false)
+    {
+        return false;
+    }
+
+    addLocked(value);
+    return true;
+}
+
+
+// Moves the values of the list over in order, waking consumers once per stretch of values moved.
+template <typename ValueType>
+void BoundedQueue<ValueType>::pushBatch(DoublyLinkedList<ValueType>& values)
+{
+    std::unique_lock<std::mutex> lock{mutex};
+
+    while (values.isEmpty() == false)
+    {
+        waitingProducers++;
+        notFull.wait(lock, [this]() { return canPush() || closed.load(std::memory_order_relaxed); });
+        waitingProducers--;
+
+        if (closed.load(std::memory_order_relaxed))
+        {
+            throw ClosedException{};
+        }
+
+        // Move as many as fit before the high watermark, then let consumers at them.
+        list.spliceToEnd(values, highWatermark - list.size());
+
+        if (list.size() >= highWatermark)
+        {
+            throttled = true;
+        }
+        count.store(list.size(), std::memory_order_relaxed);
+
+        if (waitingConsumers > 0)
+        {
+            notEmpty.notify_all();
+        }
+    }
+}
+
+
+// Removes from the start, blocking until there is something to remove.
+template <typename ValueType>
+ValueType BoundedQueue<ValueType>::pop()
+{
+    spinUntil([this]() { return count.load(std::memory_order_relaxed) > 0 || closed.load(std::memory_order_relaxed); });
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    waitingConsumers++;
+    notEmpty.wait(lock, [this]() { return list.isEmpty() == false || closed.load(std::memory_order_relaxed); });
+    waitingConsumers--;
+
+    if (list.isEmpty())
+    {
+        throw ClosedException{};
+    }
+
+    return removeLocked();
+}
+
+
+// Removes from the start, blocking until there is something to remove, but no longer than timeout.
+template <typename ValueType>
+template <typename Rep, typename Period>
+bool BoundedQueue<ValueType>::tryPop(ValueType& value, const std::chrono::duration<Rep, Period>& timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    spinUntil([this]() { return count.load(std::memory_order_relaxed) > 0 || closed.load(std::memory_order_relaxed); });
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    waitingConsumers++;
+    bool ready = notEmpty.wait_until(lock, deadline, [this]() { return list.isEmpty() == false || closed.load(std::memory_order_relaxed); });
+    waitingConsumers--;
+
+    if (ready == false)
+    {
+        return false;
+    }
+    else if (list.isEmpty()) // Woken because the queue was closed.
+    {
+        throw ClosedException{};
+    }
+
+    value = removeLocked();
+    return true;
+}
+
+
+// Removes up to maxCount values from the start, blocking until there is at least one.
+template <typename ValueType>
+DoublyLinkedList<ValueType> BoundedQueue<ValueType>::popBatch(unsigned int maxCount)
+{
+    DoublyLinkedList<ValueType> values;
+
+    spinUntil([this]() { return count.load(std::memory_order_relaxed) > 0 || closed.load(std::memory_order_relaxed); });
+
+    std::unique_lock<std::mutex> lock{mutex};
+
+    waitingConsumers++;
+    notEmpty.wait(lock, [this]() { return list.isEmpty() == false || closed.load(std::memory_order_relaxed); });
+    waitingConsumers--;
+
+    if (list.isEmpty())
+    {
+        throw ClosedException{};
+    }
+
+    values.spliceToEnd(list, maxCount);
+    count.store(list.size(), std::memory_order_relaxed);
+
+    // A whole batch may have made room for several producers at once.
+    if (list.size() <= lowWatermark)
+    {
+        throttled = false;
+
+        if (waitingProducers > 0)
+        {
+            notFull.notify_all();
+        }
+    }
+
+    return values;
+}
+
+
+// Closes the queue and wakes everyone so they can see it.
+template <typename ValueType>
+void BoundedQueue<ValueType>::close() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        closed.store(true, std::memory_order_relaxed);
+    }
+
+    notFull.notify_all();
+    notEmpty.notify_all();
+}
+
+
+// Returns true if the queue has been closed.
+template <typename ValueType>
+bool BoundedQueue<ValueType>::isClosed() const noexcept
+{
+    return closed.load(std::memory_order_relaxed);
+}
+
+
+// Returns the number of values currently in the queue.
+template <typename ValueType>
+unsigned int BoundedQueue<ValueType>::size() const noexcept
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+
+// Spins until condition is true or spinCount checks have been made.
+template <typename ValueType>
+template <typename Condition>
+bool BoundedQueue<ValueType>::spinUntil(Condition condition) const noexcept
+{
+    for (unsigned int i = 0; i < spinCount; i++)
+    {
+        if (condition())
+        {
+            return true;
+        }
+
+        std::this_thread::yield();
+    }
+
+    return false;
+}
+
+
+// Producers may add while below the high watermark and not held back by it.
+template <typename ValueType>
+bool BoundedQueue<ValueType>::canPush() const noexcept
+{
+    return throttled == false && list.size() < highWatermark;
+}
+
+
+// Adds to the end of the list and wakes one consumer.
+template <typename ValueType>
+void BoundedQueue<ValueType>::addLocked(const ValueType& value)
+{
+    list.addToEnd(value);
+    count.store(list.size(), std::memory_order_relaxed);
+
+    if (list.size() >= highWatermark)
+    {
+        throttled = true;
+    }
+
+    if (waitingConsumers > 0)
+    {
+        notEmpty.notify_one();
+    }
+}
+
+
+// Removes from the start of the list, waking producers at the low watermark.
+template <typename ValueType>
+ValueType BoundedQueue<ValueType>::removeLocked()
+{
+    ValueType value{std::move(list.first())};
+    list.removeFromStart();
+    count.store(list.size(), std::memory_order_relaxed);
+
+    if (throttled == true && list.size() <= lowWatermark)
+    {
+        throttled = false;
+
+        if (waitingProducers > 0)
+        {
+            notFull.notify_all();
+        }
+    }
+    else if (throttled == false && waitingProducers > 0)
+    {
+        notFull.notify_one();
+    }
+
+    return value;
+}
+
+
+
+#endif
+
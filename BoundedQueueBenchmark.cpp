@@ -0,0 +1,168 @@
+// BoundedQueueBenchmark.cpp
+// Measures throughput and handoff latency of a BoundedQueue used as one
+// stage of a pipeline, from 1 to 8 producers and consumers, with and
+// without watermarks and spinning, and moving values one at a time or in
+// batches of 64 with pushBatch() and popBatch().
+//
+//     g++ -std=c++17 -O2 -pthread BoundedQueueBenchmark.cpp -o BoundedQueueBenchmark
+//     ./BoundedQueueBenchmark [values per producer, default 200000]
+//
+// Every value pushed is the time it was pushed, and the consumer that pops
+// it records how long it took to arrive, including any time spent waiting
+// in the queue behind other values; the p50 and p99 of those handoff
+// latencies are reported alongside the throughput.  In batches, a value's
+// time is taken when it is added to its producer's batch, so its latency
+// includes waiting for the batch to fill.  Spinning only helps
+// when the other side is running on another core at the same time, so the
+// spinning configurations are worth comparing on a machine with at least
+// as many cores as threads.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "BenchmarkUtil.hpp"
+#include "BoundedQueue.hpp"
+
+
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+
+    std::int64_t nanosecondsNow()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+
+    struct Configuration
+    {
+        const char* name;
+        unsigned int highWatermark;
+        unsigned int lowWatermark;
+        unsigned int spinCount;
+        unsigned int batchSize; // 0 for push() and pop().
+    };
+
+
+    // Runs one pipeline stage to completion and prints its throughput and latency percentiles.
+    void run(const Configuration& configuration, unsigned int producerCount, unsigned int consumerCount, unsigned int valuesPerProducer)
+    {
+        BoundedQueue<std::int64_t> queue{configuration.highWatermark, configuration.lowWatermark, configuration.spinCount};
+        std::vector<std::vector<std::int64_t>> latencies(consumerCount);
+
+        Clock::time_point start = Clock::now();
+
+        std::vector<std::thread> consumers;
+        for (unsigned int consumer = 0; consumer < consumerCount; consumer++)
+        {
+            consumers.emplace_back([&queue, &latencies, &configuration, consumer, valuesPerProducer]
+            {
+                std::vector<std::int64_t>& mine = latencies[consumer];
+                mine.reserve(valuesPerProducer);
+
+                try
+                {
+                    for (;;)
+                    {
+                        if (configuration.batchSize == 0)
+                        {
+                            std::int64_t pushedAt = queue.pop();
+                            mine.push_back(nanosecondsNow() - pushedAt);
+                        }
+                        else
+                        {
+                            DoublyLinkedList<std::int64_t> batch = queue.popBatch(configuration.batchSize);
+                            std::int64_t now = nanosecondsNow();
+                            batch.forEach([&mine, now](std::int64_t pushedAt) { mine.push_back(now - pushedAt); });
+                        }
+                    }
+                }
+                // The queue has been closed and drained.
+                catch(ClosedException&)
+                {
+                }
+            });
+        }
+
+        std::vector<std::thread> producers;
+        for (unsigned int producer = 0; producer < producerCount; producer++)
+        {
+            producers.emplace_back([&queue, &configuration, valuesPerProducer]
+            {
+                DoublyLinkedList<std::int64_t> batch;
+
+                for (unsigned int i = 0; i < valuesPerProducer; i++)
+                {
+                    if (configuration.batchSize == 0)
+                    {
+                        queue.push(nanosecondsNow());
+                        continue;
+                    }
+
+                    batch.addToEnd(nanosecondsNow());
+                    if (batch.size() == configuration.batchSize || i + 1 == valuesPerProducer)
+                    {
+                        queue.pushBatch(batch);
+                    }
+                }
+            });
+        }
+
+        for (std::thread& producer : producers)
+        {
+            producer.join();
+        }
+
+        queue.close();
+
+        for (std::thread& consumer : consumers)
+        {
+            consumer.join();
+        }
+
+        double seconds = secondsSince(start);
+
+        std::vector<std::int64_t> all;
+        for (const std::vector<std::int64_t>& each : latencies)
+        {
+            all.insert(all.end(), each.begin(), each.end());
+        }
+
+        std::sort(all.begin(), all.end());
+
+        std::printf("%-26s %2up %2uc  %8.2f M values/s  p50 %9.1f us  p99 %9.1f us\n", configuration.name, producerCount,
+            consumerCount, all.size() / seconds / 1e6, percentile(all, 0.50) / 1000.0, percentile(all, 0.99) / 1000.0);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned int valuesPerProducer = static_cast<unsigned int>(argumentOr(argc, argv, 1, 200000));
+
+    const Configuration configurations[] = {
+        {"capacity 1024", 1024, 1023, 0, 0},
+        {"watermarks 1024/256", 1024, 256, 0, 0},
+        {"watermarks + spin 100", 1024, 256, 100, 0},
+        {"watermarks, batches of 64", 1024, 256, 0, 64},
+    };
+
+    std::printf("%u values per producer, %u hardware threads\n", valuesPerProducer, std::thread::hardware_concurrency());
+
+    for (const Configuration& configuration : configurations)
+    {
+        for (unsigned int threads = 1; threads <= 8; threads *= 2)
+        {
+            run(configuration, threads, threads, valuesPerProducer);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,603 @@
+// ByteDoublyLinkedList.hpp
+// A doubly linked list of variable-length byte strings.
+//
+// A DoublyLinkedList<std::string> needs two allocations for each value
+// that is too long for the string's own small buffer (one for the node
+// and one for the characters), and reading a value means following a
+// pointer to the node and then another to the characters.  Here, each
+// node is allocated with its bytes stored directly after the links, in
+// the same block, so each value costs one allocation and reading it only
+// touches the one block.
+//
+// Values are added as a pointer and length (or a std::string_view) and
+// are read back as std::string_views into the node, which stay valid
+// until that value is removed from the list.
+//
+// All of the public member functions listed with "noexcept" in their
+// signature never throw exceptions.  All of the others have no memory
+// leaked and the contents of the list/iterator will not have visibly
+// changed in the event that an exception has been thrown.
+
+
+#ifndef BYTEDOUBLYLINKEDLIST_HPP
+#define BYTEDOUBLYLINKEDLIST_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+#include "EmptyException.hpp"
+#include "IteratorException.hpp"
+#include "MemoryTracking.hpp"
+
+
+
+class ByteDoublyLinkedList
+{
+public:
+    class ConstIterator;
+
+
+private:
+    struct Node;
+
+
+public:
+    // Initializes this list to be empty.
+    ByteDoublyLinkedList() noexcept;
+
+    // Initializes this list as a copy of an existing one.
+    ByteDoublyLinkedList(const ByteDoublyLinkedList& list);
+
+    // Initializes this list from an expiring one.
+    ByteDoublyLinkedList(ByteDoublyLinkedList&& list) noexcept;
+
+
+    // Destroys the contents of this list.
+    ~ByteDoublyLinkedList() noexcept;
+
+
+    // Replaces the contents of this list with a copy of the contents
+    // of an existing one.
+    ByteDoublyLinkedList& operator=(const ByteDoublyLinkedList& list);
+
+    // Replaces the contents of this list with the contents of an
+    // expiring one.
+    ByteDoublyLinkedList& operator=(ByteDoublyLinkedList&& list) noexcept;
+
+
+    // addToStartBytes() adds a copy of the given bytes to the start of the
+    // list, as a single value.
+    void addToStartBytes(const void* bytes, std::size_t length);
+    void addToStartBytes(std::string_view bytes);
+
+    // addToEndBytes() adds a copy of the given bytes to the end of the
+    // list, as a single value.
+    void addToEndBytes(const void* bytes, std::size_t length);
+    void addToEndBytes(std::string_view bytes);
+
+
+    // removeFromStart() removes the first value from the list.  In the
+    // event that the list is empty, an EmptyException will be thrown.
+    void removeFromStart();
+
+    // removeFromEnd() removes the last value from the list.  In the
+    // event that the list is empty, an EmptyException will be thrown.
+    void removeFromEnd();
+
+    // clear() removes every value from the list, leaving it empty.
+    void clear() noexcept;
+
+
+    // first() and last() return views of the bytes at the start and end
+    // of the list.  In the event that the list is empty, an
+    // EmptyException will be thrown.
+    std::string_view first() const;
+    std::string_view last() const;
+
+
+    // isEmpty() returns true if the list has no values in it, false
+    // otherwise.
+    bool isEmpty() const noexcept;
+
+    // size() returns the number of values in the list.
+    unsigned int size() const noexcept;
+
+
+    // memoryFootprint() returns how much memory the list is using: its
+    // nodes, the bytes of the values inside them, and everything else
+    // (links, lengths and the list object itself).
+    MemoryFootprint memoryFootprint() const noexcept;
+
+
+    // constIterator() creates a new ConstIterator over this list.  It will
+    // initially be referring to the first value in the list (or the last
+    // one, for constIteratorAtEnd()), unless the list is empty, in which
+    // case it will be considered both "past start" and "past end".
+    ConstIterator constIterator() const noexcept;
+    ConstIterator constIteratorAtEnd() const noexcept;
+
+
+    // forEach() calls the given function with a view of each value in the
+    // list, in order from first to last.
+    template <typename Function>
+    void forEach(Function function) const;
+
+
+public:
+    class ConstIterator
+    {
+    public:
+        // moveToNext() moves this iterator forward to the next value in
+        // the list.  If the iterator is referring to the last value, it
+        // moves to the "past end" position.  If it is already at the
+        // "past end" position, an IteratorException will be thrown.
+        void moveToNext();
+
+        // moveToPrevious() moves this iterator backward to the previous
+        // value in the list.  If the iterator is referring to the first
+        // value, it moves to the "past start" position.  If it is already
+        // at the "past start" position, an IteratorException will be thrown.
+        void moveToPrevious();
+
+        // isPastStart() and isPastEnd() return true if this iterator is in
+        // the "past start" or "past end" position, false otherwise.
+        bool isPastStart() const noexcept;
+        bool isPastEnd() const noexcept;
+
+        // value() returns a view of the bytes the iterator is currently
+        // referring to.  If the iterator is in the "past start" or "past
+        // end" positions, an IteratorException will be thrown.
+        std::string_view value() const;
+
+    private:
+        friend class ByteDoublyLinkedList;
+
+        ConstIterator(const ByteDoublyLinkedList& list, bool startAtLast) noexcept;
+
+        const ByteDoublyLinkedList* itList;
+        const Node* currentNode;
+        bool pastStart;
+        bool pastEnd;
+    };
+
+
+private:
+    // The links and length of a value.  Its bytes are stored immediately
+    // after the Node, in the same allocation.
+    struct Node
+    {
+        Node* prev;
+        Node* next;
+        std::size_t length;
+
+        // bytes() returns where this node's bytes are stored.
+        unsigned char* bytes() noexcept
+        {
+            return reinterpret_cast<unsigned char*>(this + 1);
+        }
+
+        const unsigned char* bytes() const noexcept
+        {
+            return reinterpret_cast<const unsigned char*>(this + 1);
+        }
+
+        // view() returns a view of this node's bytes.
+        std::string_view view() const noexcept
+        {
+            return std::string_view{reinterpret_cast<const char*>(bytes()), length};
+        }
+    };
+
+
+    // Allocates one block holding a Node and a copy of the bytes, and
+    // reports it to the installed MemoryTracker.
+    static Node* createNode(const void* bytes, std::size_t length, Node* prev, Node* next);
+
+    // Deallocates a node created by createNode() and reports it.
+    static void destroyNode(Node* node) noexcept;
+
+    // Deletes the given node and every node after it.
+    static void destroyNodes(Node* first) noexcept;
+
+    // Builds a new chain of nodes holding copies of the values from first
+    // onward.  If an allocation throws, the nodes built so far are deleted
+    // before the exception is re-thrown.
+    static void copyNodes(const Node* first, Node*& newHead, Node*& newTail);
+
+
+    Node* head;
+    Node* tail;
+    unsigned int sz;  // Number of values.
+    std::size_t payloadBytes;  // Total length of the values.
+};
+
+
+
+// Default constructor
+inline ByteDoublyLinkedList::ByteDoublyLinkedList() noexcept
+    : head{nullptr}, tail{nullptr}, sz{0}, payloadBytes{0}
+{
+}
+
+
+// Copy Constructor
+inline ByteDoublyLinkedList::ByteDoublyLinkedList(const ByteDoublyLinkedList& list)
+    : head{nullptr}, tail{nullptr}, sz{0}, payloadBytes{0}
+{
+    copyNodes(list.head, head, tail);
+    sz = list.sz;
+    payloadBytes = list.payloadBytes;
+}
+
+
+// Move constructor: take the nodes and leave the other list empty.
+inline ByteDoublyLinkedList::ByteDoublyLinkedList(ByteDoublyLinkedList&& list) noexcept
+    : head{list.head}, tail{list.tail}, sz{list.sz}, payloadBytes{list.payloadBytes}
+{
+    list.head = list.tail = nullptr;
+    list.sz = 0;
+    list.payloadBytes = 0;
+}
+
+
+// Deconstructor
+inline ByteDoublyLinkedList::~ByteDoublyLinkedList() noexcept
+{
+    clear();
+}
+
+
+// Assignment operator: build the copy first so this list is untouched if it fails.
+inline ByteDoublyLinkedList& ByteDoublyLinkedList::operator=(const ByteDoublyLinkedList& list)
+{
+    if (this != &list)
+    {
+        Node* newHead;
+        Node* newTail;
+        copyNodes(list.head, newHead, newTail);
+
+        destroyNodes(head);
+
+        head = newHead;
+        tail = newTail;
+        sz = list.sz;
+        payloadBytes = list.payloadBytes;
+    }
+    return *this;
+}
+
+
+// Move assignment operator: swap everything, so the other list cleans up our old nodes.
+inline ByteDoublyLinkedList& ByteDoublyLinkedList::operator=(ByteDoublyLinkedList&& list) noexcept
+{
+    if (this != &list)
+    {
+        std::swap(head, list.head);
+        std::swap(tail, list.tail);
+        std::swap(sz, list.sz);
+        std::swap(payloadBytes, list.payloadBytes);
+    }
+    return *this;
+}
+
+
+// Adds a node before the head.
+inline void ByteDoublyLinkedList::addToStartBytes(const void* bytes, std::size_t length)
+{
+    Node* newNode = createNode(bytes, length, nullptr, head);
+
+    if (sz == 0)
+    {
+        tail = newNode;
+    }
+    else
+    {
+        head->prev = newNode;
+    }
+
+    head = newNode;
+    sz++;
+    payloadBytes += length;
+}
+
+
+inline void ByteDoublyLinkedList::addToStartBytes(std::string_view bytes)
+{
+    addToStartBytes(bytes.data(), bytes.size());
+}
+
+
+// Adds a node after the tail.
+inline void ByteDoublyLinkedList::addToEndBytes(const void* bytes, std::size_t length)
+{
+    Node* newNode = createNode(bytes, length, tail, nullptr);
+
+    if (sz == 0)
+    {
+        head = newNode;
+    }
+    else
+    {
+        tail->next = newNode;
+    }
+
+    tail = newNode;
+    sz++;
+    payloadBytes += length;
+}
+
+
+inline void ByteDoublyLinkedList::addToEndBytes(std::string_view bytes)
+{
+    addToEndBytes(bytes.data(), bytes.size());
+}
+
+
+inline void ByteDoublyLinkedList::removeFromStart()
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
+    }
+
+    Node* oldHead = head;
+    head = head->next;
+
+    if (head == nullptr)
+    {
+        tail = nullptr;
+    }
+    else
+    {
+        head->prev = nullptr;
+    }
+
+    sz--;
+    payloadBytes -= oldHead->length;
+    destroyNode(oldHead);
+}
+
+
+inline void ByteDoublyLinkedList::removeFromEnd()
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
+    }
+
+    Node* oldTail = tail;
+    tail = tail->prev;
+
+    if (tail == nullptr)
+    {
+        head = nullptr;
+    }
+    else
+    {
+        tail->next = nullptr;
+    }
+
+    sz--;
+    payloadBytes -= oldTail->length;
+    destroyNode(oldTail);
+}
+
+
+inline void ByteDoublyLinkedList::clear() noexcept
+{
+    destroyNodes(head);
+    head = tail = nullptr;
+    sz = 0;
+    payloadBytes = 0;
+}
+
+
+inline std::string_view ByteDoublyLinkedList::first() const
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
+    }
+
+    return head->view();
+}
+
+
+inline std::string_view ByteDoublyLinkedList::last() const
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
+    }
+
+    return tail->view();
+}
+
+
+inline bool ByteDoublyLinkedList::isEmpty() const noexcept
+{
+    return sz == 0;
+}
+
+
+inline unsigned int ByteDoublyLinkedList::size() const noexcept
+{
+    return sz;
+}
+
+
+// Everything in the nodes that isn't a value's bytes counts as overhead, as does the list object.
+inline MemoryFootprint ByteDoublyLinkedList::memoryFootprint() const noexcept
+{
+    MemoryFootprint footprint{};
+
+    footprint.nodeBytes = sz * sizeof(Node) + payloadBytes;
+    footprint.payloadBytes = payloadBytes;
+    footprint.overheadBytes = sz * sizeof(Node) + sizeof(ByteDoublyLinkedList);
+    footprint.reservedUnusedBytes = 0;
+
+    return footprint;
+}
+
+
+inline ByteDoublyLinkedList::ConstIterator ByteDoublyLinkedList::constIterator() const noexcept
+{
+    return ConstIterator{*this, false};
+}
+
+
+inline ByteDoublyLinkedList::ConstIterator ByteDoublyLinkedList::constIteratorAtEnd() const noexcept
+{
+    return ConstIterator{*this, true};
+}
+
+
+template <typename Function>
+void ByteDoublyLinkedList::forEach(Function function) const
+{
+    for (const Node* currentNode = head; currentNode != nullptr; currentNode = currentNode->next)
+    {
+        function(currentNode->view());
+    }
+}
+
+
+// One block: the Node, then its bytes right after it.
+inline ByteDoublyLinkedList::Node* ByteDoublyLinkedList::createNode(const void* bytes, std::size_t length, Node* prev, Node* next)
+{
+    void* block = ::operator new(sizeof(Node) + length);
+    Node* node = new (block) Node{prev, next, length};
+
+    if (length > 0)
+    {
+        std::memcpy(node->bytes(), bytes, length);
+    }
+
+    trackAllocation(sizeof(Node) + length);
+    return node;
+}
+
+
+inline void ByteDoublyLinkedList::destroyNode(Node* node) noexcept
+{
+    std::size_t blockBytes = sizeof(Node) + node->length;
+
+    ::operator delete(node);
+    trackDeallocation(blockBytes);
+}
+
+
+inline void ByteDoublyLinkedList::destroyNodes(Node* first) noexcept
+{
+    while (first != nullptr)
+    {
+        Node* tempNode = first;
+        first = first->next;
+        destroyNode(tempNode);
+    }
+}
+
+
+// Copies nodes from first to tail into a new chain, cleaning up if an allocation throws.
+inline void ByteDoublyLinkedList::copyNodes(const Node* first, Node*& newHead, Node*& newTail)
+{
+    newHead = newTail = nullptr;
+
+    try
+    {
+        for (const Node* listCurrentNode = first; listCurrentNode != nullptr; listCurrentNode = listCurrentNode->next)
+        {
+            Node* newNode = createNode(listCurrentNode->bytes(), listCurrentNode->length, newTail, nullptr);
+
+            if (newTail == nullptr)
+            {
+                newHead = newNode;
+            }
+            else
+            {
+                newTail->next = newNode;
+            }
+
+            newTail = newNode;
+        }
+    }
+    catch(...)
+    {
+        destroyNodes(newHead);
+        newHead = newTail = nullptr;
+        throw;
+    }
+}
+
+
+
+//
+// ConstIterator member functions //
+//
+
+
+inline ByteDoublyLinkedList::ConstIterator::ConstIterator(const ByteDoublyLinkedList& list, bool startAtLast) noexcept
+    : itList{&list},
+      currentNode{startAtLast ? list.tail : list.head},
+      pastStart{list.head == nullptr},
+      pastEnd{list.head == nullptr}
+{
+}
+
+
+inline void ByteDoublyLinkedList::ConstIterator::moveToNext()
+{
+    if (pastEnd == true)
+    {
+        throw IteratorException{};
+    }
+
+    currentNode = (pastStart == true) ? itList->head : currentNode->next;
+
+    pastStart = false;
+    pastEnd = (currentNode == nullptr);
+}
+
+
+inline void ByteDoublyLinkedList::ConstIterator::moveToPrevious()
+{
+    if (pastStart == true)
+    {
+        throw IteratorException{};
+    }
+
+    currentNode = (pastEnd == true) ? itList->tail : currentNode->prev;
+
+    pastEnd = false;
+    pastStart = (currentNode == nullptr);
+}
+
+
+inline bool ByteDoublyLinkedList::ConstIterator::isPastStart() const noexcept
+{
+    return pastStart;
+}
+
+
+inline bool ByteDoublyLinkedList::ConstIterator::isPastEnd() const noexcept
+{
+    return pastEnd;
+}
+
+
+inline std::string_view ByteDoublyLinkedList::ConstIterator::value() const
+{
+    if (pastStart == true || pastEnd == true)
+    {
+        throw IteratorException{};
+    }
+
+    return currentNode->view();
+}
+
+
+
+#endif
+
@@ -0,0 +1,139 @@
+// ByteListBenchmark.cpp
+// Compares ByteDoublyLinkedList with DoublyLinkedList<std::string> and
+// DoublyLinkedList<std::vector<char>> for payloads of 16 to 512 bytes:
+// how many allocations building the list takes, and how fast it can be
+// scanned.
+//
+//     g++ -std=c++17 -O2 ByteListBenchmark.cpp -o ByteListBenchmark
+//     ./ByteListBenchmark [values, default 500000]
+//
+// Allocations are counted by replacing the global operator new.  The scan
+// reads each value's length and first byte, which is enough to have to
+// reach the payload, as a lookup or a filter would.  The values are
+// spread over many lists, added to in random order and scanned one after
+// another, so that consecutive values weren't allocated next to each
+// other and the scan can't be carried by the hardware prefetcher.
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BenchmarkUtil.hpp"
+#include "ByteDoublyLinkedList.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    unsigned long allocationCount = 0;
+}
+
+
+
+void* operator new(std::size_t size)
+{
+    allocationCount++;
+
+    if (void* block = std::malloc(size == 0 ? 1 : size))
+    {
+        return block;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
+
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    std::free(block);
+}
+
+
+
+namespace
+{
+    // Builds lists with the given function, then scans them a few times with another, reporting both.
+    template <typename List, typename Add, typename Scan>
+    void measure(const char* name, unsigned long values, Add add, Scan scan)
+    {
+        std::vector<List> lists(1024);
+        std::mt19937 random{1};
+
+        unsigned long allocationsBefore = allocationCount;
+        for (unsigned long i = 0; i < values; i++)
+        {
+            add(lists[random() % lists.size()]);
+        }
+        unsigned long allocations = allocationCount - allocationsBefore;
+
+        unsigned long check = 0;
+
+        double best = bestOf(3, [&lists, &scan, &check]
+        {
+            check = 0;
+            for (const List& list : lists)
+            {
+                check += scan(list);
+            }
+        });
+
+        std::printf("  %-30s %4.1f allocations/value   scan %7.1f M values/s   (check %lu)\n", name,
+            static_cast<double>(allocations) / values, values / best / 1e6, check);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 500000);
+
+    std::printf("%lu values\n", values);
+
+    for (std::size_t payloadBytes = 16; payloadBytes <= 512; payloadBytes *= 2)
+    {
+        std::string payload(payloadBytes, 'x');
+        std::vector<char> vectorPayload(payload.begin(), payload.end());
+        std::printf("%zu byte payloads\n", payloadBytes);
+
+        measure<DoublyLinkedList<std::string>>("DoublyLinkedList<std::string>", values,
+            [&payload](DoublyLinkedList<std::string>& list) { list.addToEnd(payload); },
+            [](const DoublyLinkedList<std::string>& list)
+            {
+                unsigned long sum = 0;
+                list.forEach([&sum](const std::string& value) { sum += value.size() + static_cast<unsigned char>(value[0]); });
+                return sum;
+            });
+
+        measure<DoublyLinkedList<std::vector<char>>>("DoublyLinkedList<vector<char>>", values,
+            [&vectorPayload](DoublyLinkedList<std::vector<char>>& list) { list.addToEnd(vectorPayload); },
+            [](const DoublyLinkedList<std::vector<char>>& list)
+            {
+                unsigned long sum = 0;
+                list.forEach([&sum](const std::vector<char>& value) { sum += value.size() + static_cast<unsigned char>(value[0]); });
+                return sum;
+            });
+
+        measure<ByteDoublyLinkedList>("ByteDoublyLinkedList", values,
+            [&payload](ByteDoublyLinkedList& list) { list.addToEndBytes(payload); },
+            [](const ByteDoublyLinkedList& list)
+            {
+                unsigned long sum = 0;
+                list.forEach([&sum](std::string_view value) { sum += value.size() + static_cast<unsigned char>(value[0]); });
+                return sum;
+            });
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+// ClosedException.hpp
+
+// An exception to throw when interacting with a data structure that has
+// been closed, when being closed means that interaction is problematic.
+
+#ifndef CLOSEDEXCEPTION_HPP
+#define CLOSEDEXCEPTION_HPP
+
+
+class ClosedException
+{
+};
+
+
+
+#endif
+
@@ -0,0 +1,86 @@
+// CopyBenchmark.cpp
+// Measures copy construction and copy assignment of lists of ints and of
+// a small plain struct, against the same struct with a copy assignment
+// that isn't noexcept, which takes the general path.
+//
+//     g++ -std=c++17 -O2 CopyBenchmark.cpp -o CopyBenchmark
+//     ./CopyBenchmark [values, default 5000000]
+//
+// When the values can be assigned without throwing, assigning one list to
+// another of the same length reuses every node already there, so it
+// allocates nothing; otherwise the whole copy is built first and the old
+// nodes deleted afterward.
+
+
+#include <cstdio>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    struct Point
+    {
+        int x;
+        int y;
+        int z;
+        int w;
+    };
+
+
+    // The same data as a Point, but the compiler can't assume assigning it won't throw.
+    struct GeneralPoint
+    {
+        GeneralPoint() = default;
+        GeneralPoint(const GeneralPoint& other) = default;
+
+        GeneralPoint& operator=(const GeneralPoint& other)
+        {
+            point = other.point;
+            return *this;
+        }
+
+        Point point;
+    };
+
+
+    template <typename ValueType>
+    void measure(const char* name, unsigned long values)
+    {
+        DoublyLinkedList<ValueType> source;
+        for (unsigned long i = 0; i < values; i++)
+        {
+            source.addToEnd(ValueType{});
+        }
+
+        double construct = bestOf(5, [&source]
+        {
+            DoublyLinkedList<ValueType> copy{source};
+        });
+
+        DoublyLinkedList<ValueType> target{source};
+        double assign = bestOf(5, [&source, &target]
+        {
+            target = source;
+        });
+
+        std::printf("%-24s copy construct %6.1f ns/value   assign same length %6.1f ns/value\n", name,
+            construct / values * 1e9, assign / values * 1e9);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 5000000);
+
+    std::printf("%lu values\n", values);
+
+    measure<int>("int", values);
+    measure<Point>("Point", values);
+    measure<GeneralPoint>("GeneralPoint (general)", values);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// DoubleBufferedList.hpp
+// A pair of DoublyLinkedLists that lets one writer thread keep adding
+// values while one reader thread periodically takes everything added so
+// far, without the two ever waiting on a lock.
+//
+// The writer always adds to the "active" list.  To drain, the reader
+// makes the other (empty) list active, waits for any addToEnd() that may
+// still be writing to the old one to finish, and then moves the old one's
+// contents out with DoublyLinkedList's constant-time move assignment,
+// which leaves it empty and ready to become active again next time.
+//
+// The reader knows when the writer is done with the old list by watching
+// an epoch counter that the writer bumps before and after each addToEnd():
+// an odd epoch means an addToEnd() is in progress, and once the epoch
+// changes from an odd value, that addToEnd() has finished.  Any addToEnd()
+// that starts after the swap sees the new active list.  The writer never
+// waits at all, and the reader waits for at most one addToEnd().
+//
+// Only one thread may call addToEnd() and only one thread may call
+// drain(), though they can be the same thread.
+
+
+#ifndef DOUBLEBUFFEREDLIST_HPP
+#define DOUBLEBUFFEREDLIST_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include "DoublyLinkedList.hpp"
+
+
+
+template <typename ValueType>
+class DoubleBufferedList
+{
+public:
+    // Initializes this list to be empty.
+    DoubleBufferedList() noexcept;
+
+
+    // A DoubleBufferedList is shared between threads by reference, so it
+    // can neither be copied nor moved.
+    DoubleBufferedList(const DoubleBufferedList& list) = delete;
+    DoubleBufferedList& operator=(const DoubleBufferedList& list) = delete;
+
+
+    // addToEnd() adds a value to the end of the active list.  It must only
+    // be called from the writer thread.  In the event that an exception
+    // has been thrown, the value was not added.
+    void addToEnd(const ValueType& value);
+
+
+    // drain() removes every value added so far and returns them, in the
+    // order they were added.  It must only be called from the reader
+    // thread.  It takes constant time, apart from waiting for an addToEnd()
+    // that was in progress when it was called.
+    DoublyLinkedList<ValueType> drain() noexcept;
+
+
+private:
+    // Ends the writer's epoch when addToEnd() finishes, even if it throws.
+    class EpochGuard
+    {
+    public:
+        explicit EpochGuard(std::atomic<std::uint64_t>& epoch) noexcept;
+        ~EpochGuard() noexcept;
+
+    private:
+        std::atomic<std::uint64_t>& epoch;
+    };
+
+
+    DoublyLinkedList<ValueType> buffers[2];
+    std::atomic<DoublyLinkedList<ValueType>*> active;
+
+    // Odd while the writer is inside addToEnd(), even otherwise.
+    std::atomic<std::uint64_t> writerEpoch;
+};
+
+
+
+// Constructor: the first buffer starts out active.
+template <typename ValueType>
+DoubleBufferedList<ValueType>::DoubleBufferedList() noexcept
+    : buffers{}, active{&buffers[0]}, writerEpoch{0}
+{
+}
+
+
+// Enter an odd epoch before looking at which list is active, and leave it when done.
+template <typename ValueType>
+void DoubleBufferedList<ValueType>::addToEnd(const ValueType& value)
+{
+    writerEpoch.fetch_add(1, std::memory_order_seq_cst);
+    EpochGuard guard{writerEpoch};
+
+    active.load(std::memory_order_seq_cst)->addToEnd(value);
+}
+
+
+// Swap the active list, wait out the writer's current epoch if it's in one, then take the old list's nodes.
+template <typename ValueType>
+DoublyLinkedList<ValueType> DoubleBufferedList<ValueType>::drain() noexcept
+{
+    // Only the reader changes which list is active, so it can read it without ordering.
+    DoublyLinkedList<ValueType>* retired = active.load(std::memory_order_relaxed);
+    DoublyLinkedList<ValueType>* fresh = (retired == &buffers[0]) ? &buffers[1] : &buffers[0];
+
+    active.store(fresh, std::memory_order_seq_cst);
+
+    // An addToEnd() that was in progress may still be using the retired list.
+    std::uint64_t epoch = writerEpoch.load(std::memory_order_seq_cst);
+
+    if (epoch % 2 == 1)
+    {
+        while (writerEpoch.load(std::memory_order_acquire) == epoch)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Move assignment swaps the lists' nodes, leaving the retired list empty for next time.
+    DoublyLinkedList<ValueType> drained;
+    drained = std::move(*retired);
+    return drained;
+}
+
+
+template <typename ValueType>
+DoubleBufferedList<ValueType>::EpochGuard::EpochGuard(std::atomic<std::uint64_t>& epoch) noexcept
+    : epoch{epoch}
+{
+}
+
+
+template <typename ValueType>
+DoubleBufferedList<ValueType>::EpochGuard::~EpochGuard() noexcept
+{
+    epoch.fetch_add(1, std::memory_order_release);
+}
+
+
+
+#endif
+
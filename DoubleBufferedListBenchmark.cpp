@@ -0,0 +1,157 @@
+// DoubleBufferedListBenchmark.cpp
+// Measures the latency of each addToEnd() made by a writer thread while a
+// reader thread keeps draining everything it has written, for a
+// DoubleBufferedList and for a DoublyLinkedList shared behind a mutex.
+//
+//     g++ -std=c++17 -O2 -pthread DoubleBufferedListBenchmark.cpp -o DoubleBufferedListBenchmark
+//     ./DoubleBufferedListBenchmark [values, default 5000000]
+//
+// The reader drains about every 100 microseconds and then walks what it
+// drained.  With the mutex, it either walks the values while still holding
+// the lock, removing them one at a time, or moves the whole list out under
+// the lock and walks it afterward.  Every addToEnd() is timed, so the
+// numbers include the cost of reading the clock (a few tens of
+// nanoseconds).
+
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BenchmarkUtil.hpp"
+#include "DoubleBufferedList.hpp"
+
+
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+
+    // Runs the writer on this thread and the reader on another, returning every addToEnd()'s latency.
+    template <typename Add, typename Drain>
+    std::vector<std::int64_t> run(unsigned int values, Add add, Drain drain)
+    {
+        std::vector<std::int64_t> latencies;
+        latencies.reserve(values);
+
+        std::atomic<bool> writing{true};
+        long drainedSum = 0;
+
+        std::thread reader{[&writing, &drain, &drainedSum]
+        {
+            while (writing.load(std::memory_order_acquire) == true)
+            {
+                drainedSum += drain();
+                std::this_thread::sleep_for(std::chrono::microseconds{100});
+            }
+
+            drainedSum += drain();
+        }};
+
+        for (unsigned int i = 0; i < values; i++)
+        {
+            Clock::time_point start = Clock::now();
+            add(static_cast<int>(i));
+            latencies.push_back(nanosecondsSince(start));
+        }
+
+        writing.store(false, std::memory_order_release);
+        reader.join();
+
+        long expected = static_cast<long>(values) * (static_cast<long>(values) - 1) / 2;
+        if (drainedSum != expected)
+        {
+            std::printf("values were lost!\n");
+        }
+
+        return latencies;
+    }
+
+
+    long sumOf(const DoublyLinkedList<int>& list)
+    {
+        long sum = 0;
+        list.forEach([&sum](int value) { sum += value; });
+        return sum;
+    }
+
+
+    void report(const char* name, std::vector<std::int64_t> latencies)
+    {
+        std::sort(latencies.begin(), latencies.end());
+
+        std::printf("%-30s p50 %6.0f ns   p99 %7.0f ns   p99.9 %8.0f ns   max %9.0f ns\n", name, percentile(latencies, 0.5),
+            percentile(latencies, 0.99), percentile(latencies, 0.999), percentile(latencies, 1.0));
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned int values = static_cast<unsigned int>(argumentOr(argc, argv, 1, 5000000));
+
+    std::printf("%u values, %u hardware threads\n", values, std::thread::hardware_concurrency());
+
+    {
+        std::mutex mutex;
+        DoublyLinkedList<int> shared;
+
+        report("mutex, drained under the lock", run(values,
+            [&mutex, &shared](int value)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                shared.addToEnd(value);
+            },
+            [&mutex, &shared]
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+
+                long sum = 0;
+                while (shared.isEmpty() == false)
+                {
+                    sum += shared.first();
+                    shared.removeFromStart();
+                }
+
+                return sum;
+            }));
+    }
+
+    {
+        std::mutex mutex;
+        DoublyLinkedList<int> shared;
+
+        report("mutex, moved out under lock", run(values,
+            [&mutex, &shared](int value)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                shared.addToEnd(value);
+            },
+            [&mutex, &shared]
+            {
+                DoublyLinkedList<int> drained;
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    drained = std::move(shared);
+                }
+
+                return sumOf(drained);
+            }));
+    }
+
+    {
+        DoubleBufferedList<int> buffered;
+
+        report("DoubleBufferedList", run(values,
+            [&buffered](int value) { buffered.addToEnd(value); },
+            [&buffered] { return sumOf(buffered.drain()); }));
+    }
+
+    return 0;
+}
@@ -1,5 +1,7 @@
 // DoublyLinkedList.hpp
 // A Doubly Linked List template class.
+// Its nodes are allocated from the NodeStorage given as its second
+// template argument (see NodeStorage.hpp), by default with operator new.
 // All of the public member functions listed with "noexcept" in their
 // signature never throw exceptions.
 // All of the others have no memory has leaked and the contents
@@ -10,12 +12,25 @@
 #ifndef DOUBLYLINKEDLIST_HPP
 #define DOUBLYLINKEDLIST_HPP
 
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "EmptyException.hpp"
 #include "IteratorException.hpp"
+#include "MemoryTracking.hpp"
+#include "NodeStorage.hpp"
+#include "DoublyLinkedListTrace.hpp"
+
+#if __cplusplus >= 202002L
+#include <compare>
+#include <concepts>
+#endif
 
 
 
-template <typename ValueType>
+template <typename ValueType, typename NodeStorage = HeapNodeStorage>
 class DoublyLinkedList
 {
     // The forward declarations of these classes allows us to establish
@@ -30,6 +45,10 @@ public:
 private:
     struct Node;
 
+    // Ordered adaptors built on this list work with its nodes directly.
+    template <typename ElementType, typename Compare>
+    friend class SortedDoublyLinkedList;
+
 
 public:
     // Initializes this list to be empty.
@@ -79,6 +98,74 @@ public:
     void removeFromEnd();
 
 
+    // clear() removes every value from the list, leaving it empty.  Its
+    // nodes, and any spare nodes kept by clearKeepingNodes(), are given back
+    // to the NodeStorage in chains (see NodeStorage.hpp), so pooled storage
+    // takes them back in one step rather than one node at a time.
+    void clear() noexcept;
+
+    // clearKeepingNodes() removes every value from the list, like clear(),
+    // but keeps the nodes as spares for this list to reuse: adding values
+    // afterward (by any means, including copy assignment) takes spare
+    // nodes before allocating new ones, so a list that is emptied and
+    // refilled over and over, such as a per-batch buffer, stops allocating
+    // once it has reached its largest size.  Spare nodes are given back by
+    // releaseSpareNodes(), clear(), relayout() and the destructor, and are
+    // reported by memoryFootprint() as reserved but unused.  Moving a list
+    // doesn't move its spare nodes, which stay with the list they came from.
+    void clearKeepingNodes() noexcept;
+
+    // releaseSpareNodes() gives every spare node kept by clearKeepingNodes()
+    // back to the NodeStorage, leaving the values in the list untouched.
+    void releaseSpareNodes() noexcept;
+
+    // spareNodeCount() returns the number of spare nodes the list is
+    // keeping for reuse.
+    unsigned int spareNodeCount() const noexcept;
+
+
+    // spliceToEnd() moves every value of the given list to the end of
+    // this one, in the same order, leaving the given list empty.  No values
+    // are copied and no memory is allocated, so this takes constant time
+    // no matter how long either list is.  Splicing a list onto itself has
+    // no effect.
+    void spliceToEnd(DoublyLinkedList& list) noexcept;
+
+    // spliceToEnd() with a count moves only the first count values of the
+    // given list (or all of them, if it holds fewer) to the end of this
+    // one, in the same order.  No values are copied and no memory is
+    // allocated; finding where to cut the given list walks from whichever
+    // of its ends is closer to that point.  Splicing from a list onto
+    // itself has no effect.
+    void spliceToEnd(DoublyLinkedList& list, unsigned int count) noexcept;
+
+
+    // rotateLeft() moves the first count values to the end of the list,
+    // in the same order, and rotateRight() moves the last count values to
+    // the start of it.  Rotating by the size of the list (or any multiple
+    // of it) has no effect.  Only links are changed; no values are copied
+    // and no memory is allocated, and existing iterators still refer to
+    // the same values.
+    void rotateLeft(unsigned int count) noexcept;
+    void rotateRight(unsigned int count) noexcept;
+
+
+    // moveToFront() and moveToBack() move the value the given iterator
+    // refers to so that it becomes the first or last value in the list.
+    // The iterator still refers to that value afterward.  Only links are
+    // changed.  If the iterator is in the "past start" or "past end"
+    // position, or is not an iterator over this list, an IteratorException
+    // will be thrown.
+    void moveToFront(const Iterator& iterator);
+    void moveToBack(const Iterator& iterator);
+
+
+    // reverse() reverses the order of the values in the list by swapping
+    // the links of every node.  Existing iterators still refer to the same
+    // values, and so move in the opposite direction through them.
+    void reverse() noexcept;
+
+
     // first() returns the value at the start of the list.  In the event that
     // the list is empty, an EmptyException will be thrown.  There are two
     // variants of this member function: one for a const DoublyLinkedList and
@@ -104,6 +191,17 @@ public:
     unsigned int size() const noexcept;
 
 
+    // memoryFootprint() returns how much memory the list is using: its
+    // nodes, the part of them holding values, and everything else (links,
+    // padding and the list object itself).  Memory allocated by the values
+    // themselves is not included.  When the NodeStorage keeps memory for
+    // nodes that aren't in use, the amount is reported too, as a measure
+    // of fragmentation; since that memory is shared by every list with the
+    // same node type, it is not specific to this list.  Spare nodes kept by
+    // clearKeepingNodes() are counted as reserved but unused as well.
+    MemoryFootprint memoryFootprint() const noexcept;
+
+
     // iterator() creates a new Iterator over this list.  It will
     // initially be referring to the first value in the list, unless the
     // list is empty, in which case it will be considered both "past start"
@@ -118,6 +216,78 @@ public:
     ConstIterator constIterator() const;
 
 
+    // iteratorAtEnd() and constIteratorAtEnd() are like iterator() and
+    // constIterator(), except that the new iterator will initially be
+    // referring to the last value in the list, so that it can be used to
+    // walk the list backward.
+    Iterator iteratorAtEnd();
+    ConstIterator constIteratorAtEnd() const;
+
+
+    // forEach() calls the given function once with each value in the list,
+    // in order from first to last.  There are two variants of this member
+    // function: one for a const DoublyLinkedList and another for a
+    // non-const one.
+    template <typename Function>
+    void forEach(Function function) const;
+    template <typename Function>
+    void forEach(Function function);
+
+
+    // relayout() reallocates the nodes of the list one at a time in order
+    // from first to last, so that neighbouring values end up (as far as the
+    // allocator allows) in neighbouring memory.  Walking a list whose nodes
+    // are scattered waits on memory at every node, since each node's
+    // address is only known once the one before it has arrived; walking
+    // nodes that sit in order lets the hardware prefetcher load them ahead
+    // of time.  The values are moved into their
+    // new nodes when that can't throw, and copied otherwise.  Spare nodes
+    // kept by clearKeepingNodes() are given back first rather than reused,
+    // since they sit wherever the old nodes did.  Any existing
+    // iterators over the list are no longer valid afterward.
+    void relayout();
+
+
+    // operator==() returns true if both lists hold the same number of
+    // values and each value is equal to the one in the same position of
+    // the other list.  Lists of different sizes are told apart without
+    // looking at any values.
+    bool operator==(const DoublyLinkedList& list) const;
+
+#if __cplusplus >= 202002L
+    // operator<=>() compares the lists lexicographically: by the first
+    // pair of values that differ, or, if one list runs out of values
+    // first, by size.  Values are compared with their own operator<=>
+    // when they have one, or with operator< otherwise.
+    auto operator<=>(const DoublyLinkedList& list) const;
+#else
+    // operator!=() is the opposite of operator==(), and operator<(),
+    // operator>(), operator<=() and operator>=() compare the lists
+    // lexicographically: by the first pair of values that differ, or, if
+    // one list runs out of values first, by size.  Values are compared
+    // with operator<.
+    bool operator!=(const DoublyLinkedList& list) const;
+    bool operator<(const DoublyLinkedList& list) const;
+    bool operator>(const DoublyLinkedList& list) const;
+    bool operator<=(const DoublyLinkedList& list) const;
+    bool operator>=(const DoublyLinkedList& list) const;
+#endif
+
+
+    // hash() returns a hash of the values in the list, in order, built from
+    // std::hash of each value; std::hash of a DoublyLinkedList calls it.
+    // The first call walks the list, after which the result is kept up to
+    // date by addToStart(), addToEnd(), removeFromStart(), removeFromEnd()
+    // and clear(), so hashing a list again (say, a sliding window) takes
+    // constant time.  Anything else that could change the values, such as
+    // the non-const first(), last() and forEach(), or creating an Iterator,
+    // makes the next call walk the list again.  A value changed through a
+    // reference kept from before the last call is not noticed.  Because
+    // the result is stored in the list, hash() must not be called from two
+    // threads at once, even on a const list.
+    std::size_t hash() const;
+
+
 public:
     // The IteratorBase class is the base class for our two kinds of
     // iterators.  Because there are so many similarities between them,
@@ -128,9 +298,10 @@ public:
     public:
         // Initializes a newly-constructed IteratorBase to operate on
         // the given list.  It will initially be referring to the first
-        // value in the list, unless the list is empty, in which case
-        // it will be considered to be both "past start" and "past end".
-        IteratorBase(const DoublyLinkedList& list) noexcept;
+        // value in the list (or the last one, if startAtLast is true),
+        // unless the list is empty, in which case it will be considered
+        // to be both "past start" and "past end".
+        IteratorBase(const DoublyLinkedList& list, bool startAtLast = false) noexcept;
 
 
         // moveToNext() moves this iterator forward to the next value in
@@ -155,14 +326,16 @@ public:
         // isPastEnd() returns true if this iterator is in the "past end"
         // position, false otherwise.
         bool isPastEnd() const noexcept;
+
+    private:
+        // The list positions iterators at particular nodes.
+        friend class DoublyLinkedList;
     
     protected:
         // Accessible to the derived classes.
         bool pastStart;
         bool pastEnd;
-        unsigned int* itSize;
-        Node* itHead;
-        Node* itTail;
+        DoublyLinkedList* itList;
         Node* currentNode;
     };
 
@@ -172,9 +345,10 @@ public:
     public:
         // Initializes a newly-constructed ConstIterator to operate on
         // the given list.  It will initially be referring to the first
-        // value in the list, unless the list is empty, in which case
-        // it will be considered to be both "past start" and "past end".
-        ConstIterator(const DoublyLinkedList& list) noexcept;
+        // value in the list (or the last one, if startAtLast is true),
+        // unless the list is empty, in which case it will be considered
+        // to be both "past start" and "past end".
+        ConstIterator(const DoublyLinkedList& list, bool startAtLast = false) noexcept;
 
 
         // value() returns the value that the iterator is currently
@@ -189,9 +363,10 @@ public:
     public:
         // Initializes a newly-constructed Iterator to operate on the
         // given list.  It will initially be referring to the first
-        // value in the list, unless the list is empty, in which case
-        // it will be considered to be both "past start" and "past end".
-        Iterator(DoublyLinkedList& list) noexcept;
+        // value in the list (or the last one, if startAtLast is true),
+        // unless the list is empty, in which case it will be considered
+        // to be both "past start" and "past end".
+        Iterator(DoublyLinkedList& list, bool startAtLast = false) noexcept;
 
 
         // value() returns the value that the iterator is currently
@@ -238,87 +413,110 @@ private:
     };
 
 
+    // Takes a spare node, or allocates one from the NodeStorage if there
+    // are none, initializes it from the given arguments (its value, then
+    // its prev and next pointers) and reports it to the installed
+    // MemoryTracker.  Every node in the list is created this way.
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+
+    // Deallocates a node created by createNode() and reports it to the
+    // installed MemoryTracker.
+    static void destroyNode(Node* node) noexcept;
+
+    // Deletes the given node and every node after it, giving them back to
+    // the NodeStorage in chains as long as it asks for.
+    static void destroyNodes(Node* first) noexcept;
+
+    // Builds a new chain of nodes holding copies of the values from first
+    // onward, storing its ends into newHead and newTail (both nullptr when
+    // first is nullptr).  If a copy or allocation throws, the nodes built
+    // so far are deleted before the exception is re-thrown.
+    void copyNodes(const Node* first, Node*& newHead, Node*& newTail);
+
+    // Creates a node holding a copy of the value and links it in before
+    // the given node, or at the end of the list if that node is nullptr,
+    // keeping head, tail and sz up to date.  Returns the new node.  If the
+    // copy or allocation throws, the list is unchanged.
+    Node* insertNodeBefore(Node* position, const ValueType& value);
+
+    // Unlinks the given node from the list without deleting it, keeping
+    // head, tail and sz up to date.
+    void unlinkNode(Node* node) noexcept;
+
+    // constIteratorAt() creates a ConstIterator referring to the given
+    // node, or in the "past end" position if that node is nullptr.
+    ConstIterator constIteratorAt(const Node* node) const noexcept;
+
+#if __cplusplus >= 202002L
+    // Compares two values for operator<=>(), synthesizing an ordering from
+    // operator< for values that don't have an operator<=>.
+    static auto compareValues(const ValueType& first, const ValueType& second);
+#endif
+
+    // Updates the cached hash, if there is one, for a value that was just
+    // added at (or is about to be removed from) the start or end of the
+    // list.  If hashing the value throws, the cached hash is dropped.
+    void updateCachedHash(const ValueType& value, bool atEnd, bool added) const noexcept;
+
+
     Node* head;
     Node* tail;
     unsigned int sz;  // Size of DLL.
-    unsigned int* pSZ = &sz; // Pointer to reference for use in IteratorBase and derived classes.
+
+    // Nodes kept by clearKeepingNodes(), with their values destroyed,
+    // linked by a NodeChainLink at the start of each.
+    void* spareNodes;
+    unsigned int spareCount;
+
+    // The hash of the values in order, as a polynomial in hashMultiplier
+    // with the first value's hash as its highest term, and hashMultiplier
+    // raised to the power of sz; only meaningful while hashValid is true.
+    mutable bool hashValid;
+    mutable std::size_t cachedHash;
+    mutable std::size_t hashPower;
+
+    // Odd, so that it has a multiplicative inverse modulo 2^N, which lets
+    // values be taken back off of either end of the polynomial.
+    static constexpr std::size_t hashMultiplier = static_cast<std::size_t>(0x100000001b3ULL);
+    static constexpr std::size_t inverseHashMultiplier();
 };
 
 
 // Default constructor
-template <typename ValueType>
-DoublyLinkedList<ValueType>::DoublyLinkedList() noexcept
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::DoublyLinkedList() noexcept
 {
     head = tail = nullptr;
     sz = 0;
+
+    spareNodes = nullptr;
+    spareCount = 0;
+
+    hashValid = false;
+    cachedHash = 0;
+    hashPower = 1;
 }
 
 
 // Copy Constructor
-template <typename ValueType>
-DoublyLinkedList<ValueType>::DoublyLinkedList(const DoublyLinkedList& list)
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::DoublyLinkedList(const DoublyLinkedList& list)
+    : head{nullptr}, tail{nullptr}, sz{0}, spareNodes{nullptr}, spareCount{0}, hashValid{list.hashValid}, cachedHash{list.cachedHash},
+      hashPower{list.hashPower}
 {
-    try
-    {
-        Node* listCurrentNode = list.head; // Keeps track of nodes in other list without modifying any nodes.
-
-        head = new Node
-                    {
-                        listCurrentNode->value,
-                        nullptr,
-                        nullptr
-                    };
-        
-        Node* thisCurrentNode = head;  // Only do this once so head points to correct first created node.
-
-        // Set up for next possible node or nullptr if no more nodes to link.
-        listCurrentNode = listCurrentNode->next;  // Could be nullptr or filled Node.
-
-        // IF MORE THAN ONE NODE, LINK THE NODE TOGETHER BASED ON NODE COUNT/SIZE OF LIST (OTHER DLL).
-        while(listCurrentNode != nullptr)
-        {
-            Node* thisPreviousNode = thisCurrentNode; 
-            thisCurrentNode = thisCurrentNode->next;
-
-            thisCurrentNode = new Node
-                                    {
-                                        listCurrentNode->value,
-                                        thisPreviousNode, // Link back.
-                                        nullptr
-                                    };
-            thisPreviousNode->next = thisCurrentNode; // Link forward.
-        
-            tail = thisCurrentNode;
-
-            // Could be another node of list OR nullptr which will break while loop.
-            listCurrentNode = listCurrentNode->next;
-        }
-        // After exiting the while loop, the head should point to the first node.
-
-        sz = list.sz;  
-    }
-    // Catch exception/error, deallocate memory (to avoid memory leak), then re-throw exception/error.
-    catch(...)
-    {
-        // Return to being empty with size = 0 and head/tail point to nullptr.
-        while (head != nullptr)
-        {
-            Node* tempNode = head;
-            head = head->next;
-            delete tempNode;
-        }
-        head = tail = nullptr;
-        sz = 0;
+    DOUBLYLINKEDLIST_TRACE("copy construct");
 
-        throw;
-    }
+    // If copying fails partway, copyNodes() cleans up after itself and nothing here needs undoing.
+    copyNodes(list.head, head, tail);
+    sz = list.sz;
 }
 
 
 // move copy constructor
-template <typename ValueType>
-DoublyLinkedList<ValueType>::DoublyLinkedList(DoublyLinkedList&& list) noexcept
-    : head{nullptr}, tail{nullptr}, sz{0}
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::DoublyLinkedList(DoublyLinkedList&& list) noexcept
+    : head{nullptr}, tail{nullptr}, sz{0}, spareNodes{nullptr}, spareCount{0}, hashValid{false}, cachedHash{0}, hashPower{1}
 {
     Node* thisHead = head; // Stays pointing at original head.
     head = list.head; // Make our head point to other List.head.
@@ -333,102 +531,124 @@ DoublyLinkedList<ValueType>::DoublyLinkedList(DoublyLinkedList&& list) noexcept
     tempSize = sz;
     sz = list.sz;
     list.sz = tempSize;
+
+    // The cached hash belongs to the values, so it goes with them.
+    std::swap(hashValid, list.hashValid);
+    std::swap(cachedHash, list.cachedHash);
+    std::swap(hashPower, list.hashPower);
 }
 
 // Deconstructor
-template <typename ValueType>
-DoublyLinkedList<ValueType>::~DoublyLinkedList() noexcept
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::~DoublyLinkedList() noexcept
 {
-    while (head != nullptr)
-    {
-        Node* currentNode = head;
-        head = head->next;
-        delete currentNode;
-    }
-    // Ensure these member variables die.
-    head = tail = nullptr;
+    clear();
 }
 
 // Assignment operator
-template <typename ValueType>
-DoublyLinkedList<ValueType>& DoublyLinkedList<ValueType>::operator=(const DoublyLinkedList& list)
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>& DoublyLinkedList<ValueType, NodeStorage>::operator=(const DoublyLinkedList& list)
 {
-    Node* newHead = nullptr;
-    Node* newTail = nullptr;
+    DOUBLYLINKEDLIST_TRACE("copy assign");
 
     if (this != &list)
     {
-        try
+        if constexpr (std::is_nothrow_copy_assignable<ValueType>::value)
         {
-            Node* listCurrentNode = list.head; // Keeps track of nodes in other list without modifying any nodes.
-
-            newHead = new Node
-                        {
-                            listCurrentNode->value,
-                            nullptr,
-                            nullptr
-                        };
-            
-            Node* thisCurrentNode = newHead;  // Only do this once so head points to correct first created node.
-
-            // Set up for next possible node or nullptr if no more nodes to link.
-            listCurrentNode = listCurrentNode->next;  // Could be nullptr or filled Node.
-
-            // IF MORE THAN ONE NODE, LINK THE NODE TOGETHER BASED ON NODE COUNT/SIZE OF LIST (OTHER DLL).
-            while(listCurrentNode != nullptr)
+            // Values can be assigned without throwing, so the nodes this list already has are
+            // reused in place and only the difference in length is allocated or deleted.
+            // The values that won't fit into existing nodes start at position sz of the other
+            // list, if it is longer, which is found from whichever of its ends is closer.
+            Node* listCurrentNode = nullptr;
+            Node* thisCurrentNode;
+
+            if (list.sz > sz && sz <= list.sz - sz)
+            {
+                listCurrentNode = list.head;
+                for (unsigned int i = 0; i < sz; i++)
+                {
+                    listCurrentNode = listCurrentNode->next;
+                }
+            }
+            else if (list.sz > sz)
             {
-                Node* thisPreviousNode = thisCurrentNode; 
-                thisCurrentNode = thisCurrentNode->next;
-
-                thisCurrentNode = new Node
-                                        {
-                                            listCurrentNode->value,
-                                            thisPreviousNode, // Link back.
-                                            nullptr
-                                        };
-                thisPreviousNode->next = thisCurrentNode; // Link forward.
-            
-                newTail = thisCurrentNode;
-
-                // Could be another node of list OR nullptr which will break while loop.
+                listCurrentNode = list.tail;
+                for (unsigned int i = list.sz - 1; i > sz; i--)
+                {
+                    listCurrentNode = listCurrentNode->prev;
+                }
+            }
+
+            // Copying the values that don't fit is the only step that can throw, so it goes
+            // first, while this list is still intact.
+            Node* extraHead;
+            Node* extraTail;
+            copyNodes(listCurrentNode, extraHead, extraTail);
+
+            // Nothing from here on can throw.
+            Node* lastReusedNode = nullptr;
+            listCurrentNode = list.head;
+
+            for (thisCurrentNode = head; listCurrentNode != nullptr && thisCurrentNode != nullptr; thisCurrentNode = thisCurrentNode->next)
+            {
+                thisCurrentNode->value = listCurrentNode->value;
+                lastReusedNode = thisCurrentNode;
                 listCurrentNode = listCurrentNode->next;
             }
 
-            // Delete all current nodes from this DLL if any exist.
-            while (head != nullptr)
+            if (lastReusedNode == nullptr) // One of the lists was empty, so no nodes were reused.
+            {
+                destroyNodes(head);
+                head = extraHead;
+                tail = extraTail;
+            }
+            else
             {
-                Node* tempNode = head;
-                head = head->next;
-                delete tempNode;
+                // Delete the nodes this list had beyond the length of the other one, if any,
+                // then attach the extra nodes, if any.
+                destroyNodes(lastReusedNode->next);
+                lastReusedNode->next = extraHead;
+
+                if (extraHead != nullptr)
+                {
+                    extraHead->prev = lastReusedNode;
+                    tail = extraTail;
+                }
+                else
+                {
+                    tail = lastReusedNode;
+                }
             }
+        }
+        else
+        {
+            // Build the whole copy first so that this list is left untouched if it fails.
+            Node* newHead;
+            Node* newTail;
+            copyNodes(list.head, newHead, newTail);
 
-            head = tail = nullptr;
+            // Delete all current nodes from this DLL if any exist.
+            destroyNodes(head);
 
             // Repoint head and tail to new DLL.
             head = newHead;
             tail = newTail;
-            // this size = list size
-            sz = list.sz;  
-        } 
-        // Catch exception/error, deallocate memory (to avoid memory leak), then re-throw exception/error.
-        catch(...)
-        {
-            // Original head, tail, size stays intact.
-            while (newHead != nullptr)
-            {
-                Node* tempNode = newHead;
-                newHead = newHead->next;
-                delete tempNode;
-            }
-            throw;
-        }    
+        }
+
+        // this size = list size
+        sz = list.sz;
+
+        hashValid = list.hashValid;
+        cachedHash = list.cachedHash;
+        hashPower = list.hashPower;
     }
     return *this;
 }
 
+
 // Move assigntment operator.
-template <typename ValueType>
-DoublyLinkedList<ValueType>& DoublyLinkedList<ValueType>::operator=(DoublyLinkedList&& list) noexcept
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>& DoublyLinkedList<ValueType, NodeStorage>::operator=(DoublyLinkedList&& list) noexcept
 {
     if (this != &list)
     {
@@ -448,106 +668,87 @@ DoublyLinkedList<ValueType>& DoublyLinkedList<ValueType>::operator=(DoublyLinked
         tempSize = sz;
         sz = list.sz;
         list.sz = tempSize;
+
+        std::swap(hashValid, list.hashValid);
+        std::swap(cachedHash, list.cachedHash);
+        std::swap(hashPower, list.hashPower);
     }
     return *this;
 }
 
 
 // Adds node to the front with a particular value and repoints head.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::addToStart(const ValueType& value)
+// If copying the value or allocating the node throws, nothing has been changed yet.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::addToStart(const ValueType& value)
 {
-    Node* newNode = new Node{value, nullptr, nullptr};
+    DOUBLYLINKEDLIST_TRACE("addToStart");
 
-    Node* originalHeadNode = head;
+    Node* newNode = createNode(value, nullptr, head);
 
     if (sz == 0) // DLL is empty
     {
-        head = tail = newNode;
-        sz++;
+        tail = newNode;
     }
     else // (size is > 0)
     {
-        try
-        {
-            // Can anything go wrong here in this try?  If it does, catch it and no memory is leaked.
-            Node* tempNode = head;
-            head->prev = newNode;
-            head = newNode;
-
-            head->value = value;
-            head->prev = nullptr;
-            head->next = tempNode;
-
-            sz++;  // If the try has gotten this far, size will not throw an exception.
-        }
-        catch(...)
-        {
-            delete newNode;
+        head->prev = newNode;
+    }
 
-            // head = nodeBeforeHead->prev;
-            head = originalHeadNode;      
+    head = newNode;
+    sz++;
 
-            throw;
-        }
-    }
+    updateCachedHash(value, false, true);
 }
 
 // Adds node to the back with a particular value and repoints tail.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::addToEnd(const ValueType& value)
+// If copying the value or allocating the node throws, nothing has been changed yet.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::addToEnd(const ValueType& value)
 {
-    Node* newNode = new Node{value, nullptr, nullptr};
+    DOUBLYLINKEDLIST_TRACE("addToEnd");
 
-    Node* originalTail = tail;
+    Node* newNode = createNode(value, tail, nullptr);
 
     if (sz == 0)
     {
-        head = tail = newNode;
-        sz++;
+        head = newNode;
     }
     else
     {
-        try
-        {
-            Node* tempNode = tail;
-            tail->next = newNode;
-            tail = newNode;
-
-            tail->value = value;
-            tail->prev = tempNode;
-            tail->next = nullptr;
+        tail->next = newNode;
+    }
 
-            sz++;
-        }
-        catch(...)
-        {
-            delete newNode;
-            tail = originalTail;
+    tail = newNode;
+    sz++;
 
-            throw;
-        }
-    }
+    updateCachedHash(value, true, true);
 }
 
 
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::removeFromStart()
+
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::removeFromStart()
 {
+    DOUBLYLINKEDLIST_TRACE("removeFromStart");
+
     if (sz == 0)
     {
         throw EmptyException{};
     }
-    else if (sz == 1)
+
+    updateCachedHash(head->value, false, false);
+
+    if (sz == 1)
     {
-        delete head;
+        destroyNode(head);
         head = tail = nullptr;
         sz--;
     }
     else // sz >= 2
     {
         head = head->next;
-        delete head->prev;
+        destroyNode(head->prev);
         head->prev = nullptr;
         sz--;
     }    
@@ -555,510 +756,1218 @@ void DoublyLinkedList<ValueType>::removeFromStart()
 
 
 // Remove node from end of the DLL and repoint tail.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::removeFromEnd()
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::removeFromEnd()
 {
+    DOUBLYLINKEDLIST_TRACE("removeFromEnd");
+
     if (sz == 0)
     {
         throw EmptyException{};
     }
-    else if (sz == 1)
+
+    updateCachedHash(tail->value, true, false);
+
+    if (sz == 1)
     {
-        delete tail;
+        destroyNode(tail);
         head = tail = nullptr;
         sz--;
     }
     else
     {
         tail = tail->prev;
-        delete tail->next;
+        destroyNode(tail->next);
         tail->next = nullptr;
         sz--;
     } 
 }
 
 
-// Returns the value of the head (first node) that CANNOT change or be modified.
-template <typename ValueType>
-const ValueType& DoublyLinkedList<ValueType>::first() const
+// Deletes every node and returns to being empty with size = 0 and head/tail point to nullptr.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::clear() noexcept
 {
-    if (sz == 0)
-    {
-        throw EmptyException{};
-    }
-    else
-    {
-        return head->value;
-    } 
-}
+    destroyNodes(head);
+    head = tail = nullptr;
+    sz = 0;
 
-// Returns the value of the head (first node) that CAN change or be modified.
-template <typename ValueType>
-ValueType& DoublyLinkedList<ValueType>::first()
-{
-    if (sz == 0)
-    {
-        throw EmptyException{};
-    }
-    else
-    {
-        return head->value;
-    } 
+    releaseSpareNodes();
+
+    // If the hash was being kept up to date, it carries on from the empty list's.
+    cachedHash = 0;
+    hashPower = 1;
 }
 
 
-// Returns the value of the last (last node) that CANNOT change or be modified.
-template <typename ValueType>
-const ValueType& DoublyLinkedList<ValueType>::last() const
+// Destroys every value, turning each node into a link in the spare chain, and returns to being empty.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::clearKeepingNodes() noexcept
 {
-    if (sz == 0)
-    {
-        throw EmptyException{};
-    }
-    else
+    Node* currentNode = head;
+
+    while (currentNode != nullptr)
     {
-        return tail->value;
-    } 
-}
+        Node* nextNode = currentNode->next;
 
+        currentNode->~Node();
+        new (currentNode) NodeChainLink{spareNodes};
+        trackDeallocation(sizeof(Node));
 
-// Returns the value of the last (last node) that CAN change or be modified.
-template <typename ValueType>
-ValueType& DoublyLinkedList<ValueType>::last()
-{
-    if (sz == 0)
-    {
-        throw EmptyException{};
+        spareNodes = currentNode;
+        spareCount++;
+        currentNode = nextNode;
     }
-    else
-    {
-        return tail->value;
-    } 
-}
 
-// Returns the size of the DLL that is modified in the DLL class and IteratorBase with its derived iterator classes.
-template <typename ValueType>
-unsigned int DoublyLinkedList<ValueType>::size() const noexcept
-{
-    return sz;
+    head = tail = nullptr;
+    sz = 0;
+
+    cachedHash = 0;
+    hashPower = 1;
 }
 
 
-// Returns true of list is empty, false if not empty.
-template <typename ValueType>
-bool DoublyLinkedList<ValueType>::isEmpty() const noexcept
+// Cuts the spare chain into pieces of NodeStorage::nodesPerChain nodes and gives each one back.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::releaseSpareNodes() noexcept
 {
-    if (head == nullptr && tail == nullptr && sz == 0)
-    {
-        return true;
-    }
-    else
+    while (spareNodes != nullptr)
     {
-        return false;
-    }
-}
+        void* first = spareNodes;
+        void* lastNode = first;
+        std::size_t count = 1;
 
+        while (count < NodeStorage::nodesPerChain && static_cast<NodeChainLink*>(lastNode)->next != nullptr)
+        {
+            lastNode = static_cast<NodeChainLink*>(lastNode)->next;
+            count++;
+        }
 
-//
-// Iterator member functions //
-//
+        spareNodes = static_cast<NodeChainLink*>(lastNode)->next;
+        static_cast<NodeChainLink*>(lastNode)->next = nullptr;
 
+        NodeStorage::template deallocateChain<sizeof(Node), alignof(Node)>(first, lastNode, count);
+    }
 
-// Construct modifiable iterator.
-template <typename ValueType>
-typename DoublyLinkedList<ValueType>::Iterator DoublyLinkedList<ValueType>::iterator()
-{
-    return Iterator{*this};
+    spareCount = 0;
 }
 
 
-// Construct constant iterator.
-template <typename ValueType>
-typename DoublyLinkedList<ValueType>::ConstIterator DoublyLinkedList<ValueType>::constIterator() const
+template <typename ValueType, typename NodeStorage>
+unsigned int DoublyLinkedList<ValueType, NodeStorage>::spareNodeCount() const noexcept
 {
-    return ConstIterator{*this};
+    return spareCount;
 }
 
 
-// Class that Iterator and ConstIterator derives from using the DLL.
-template <typename ValueType>
-DoublyLinkedList<ValueType>::IteratorBase::IteratorBase(const DoublyLinkedList& list) noexcept
+// Relinks the other list's nodes after this tail and leaves the other list empty.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::spliceToEnd(DoublyLinkedList& list) noexcept
 {
-    itHead = list.head;
-    itTail = list.tail;
-    itSize = list.pSZ;
+    if (this == &list || list.sz == 0)
+    {
+        return;
+    }
 
-    // If list is empty.
-    if (itHead == nullptr && itTail == nullptr)
+    if (sz == 0)
     {
-        itSize = 0;
-        currentNode = nullptr;
-        pastStart = true;
-        pastEnd = true;
+        head = list.head;
     }
-    // If list is NOT empty.
-    else // itHead will refer to the first value in the list.
+    else
     {
-        pastStart = false;
-        pastEnd = false;
-
-        currentNode = itHead;
+        tail->next = list.head;
+        list.head->prev = tail;
     }
+
+    tail = list.tail;
+    sz += list.sz;
+    hashValid = false;
+
+    list.head = list.tail = nullptr;
+    list.sz = 0;
+    list.hashValid = false;
 }
 
 
-// Current position moves to next node towards tail.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::IteratorBase::moveToNext()
+// Finds the last node to move, then cuts the other list after it and relinks the front part after this tail.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::spliceToEnd(DoublyLinkedList& list, unsigned int count) noexcept
 {
-    // If current position is nullptr after tail.
-    if (currentNode == nullptr && pastStart == false && pastEnd == true) // CurrentNode is pastStart.
+    if (count >= list.sz)
     {
-        throw IteratorException{};
+        spliceToEnd(list);
+        return;
     }
-    // If current position is nullptr before head, move to head.
-    else if (currentNode == nullptr && pastStart == true && pastEnd == false)
+    else if (this == &list || count == 0)
     {
-        currentNode = itHead;
-
-        pastStart = false;
-        pastEnd = false;
+        return;
     }
-    // If current position is node before tail, set to tail.
-    else if (currentNode->next == itTail)
-    {
-        currentNode = itTail;
 
-        pastStart = false;
-        pastEnd = false;
+    Node* lastMoved;
+
+    if (count <= list.sz - count)
+    {
+        lastMoved = list.head;
+        for (unsigned int i = 1; i < count; i++)
+        {
+            lastMoved = lastMoved->next;
+        }
     }
-    // Current position from head to tail - 1
     else
     {
-        currentNode = currentNode->next;
-
-        // If current position IS the tail, it is now nullptr and pastEnd.
-        if (currentNode == nullptr)
+        lastMoved = list.tail;
+        for (unsigned int i = list.sz; i > count; i--)
         {
-            pastStart = false;
-            pastEnd = true;
+            lastMoved = lastMoved->prev;
         }
     }
+
+    Node* firstMoved = list.head;
+
+    list.head = lastMoved->next;
+    list.head->prev = nullptr;
+    lastMoved->next = nullptr;
+    list.sz -= count;
+    list.hashValid = false;
+
+    if (sz == 0)
+    {
+        head = firstMoved;
+    }
+    else
+    {
+        tail->next = firstMoved;
+        firstMoved->prev = tail;
+    }
+
+    tail = lastMoved;
+    sz += count;
+    hashValid = false;
 }
 
 
-// Current position moves to next node towards head.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::IteratorBase::moveToPrevious()
+// Makes the node at index count the new head by joining the tail to the head and
+// cutting the links just before that node.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::rotateLeft(unsigned int count) noexcept
 {
-    // If current position is nullptr before head.
-    if (currentNode == nullptr && pastStart == true && pastEnd == false) // CurrentNode is pastStart.
+    if (sz == 0)
     {
-        throw IteratorException{};
+        return;
     }
-    // If current position is nullptr after tail, move to tail.
-    else if (currentNode == nullptr && pastStart == false && pastEnd == true)
+
+    count %= sz;
+
+    if (count == 0)
     {
-        currentNode = itTail;
-    
-        pastStart = false;
-        pastEnd = false;
+        return;
     }
-    // If current position is node BEFORE head, set head to this node.
-    else if (currentNode->prev == itHead)
-    {
-        currentNode = itHead;
 
-        pastStart = false;
-        pastEnd = false;
+    // Find the new head from whichever end of the list is closer.
+    Node* newHead;
+
+    if (count <= sz / 2)
+    {
+        newHead = head;
+        for (unsigned int i = 0; i < count; i++)
+        {
+            newHead = newHead->next;
+        }
     }
-    // Current position from head + 1 to tail.
     else
     {
-        currentNode = currentNode->prev;
-
-        // If current position IS the head, it is now nullptr and pastStart.
-        if (currentNode == nullptr)
+        newHead = tail;
+        for (unsigned int i = sz - 1; i > count; i--)
         {
-            pastStart = true;
-            pastEnd = false;
+            newHead = newHead->prev;
         }
     }
-}
 
+    // Close the list into a ring, then open it again just before newHead.
+    tail->next = head;
+    head->prev = tail;
 
-// Returns true if the current position is in the pastStart position, false otherwise.
-template <typename ValueType>
-bool DoublyLinkedList<ValueType>::IteratorBase::isPastStart() const noexcept
-{
-    return pastStart;
+    tail = newHead->prev;
+    tail->next = nullptr;
+    newHead->prev = nullptr;
+    head = newHead;
+    hashValid = false;
 }
 
 
-// Returns true if the current position is in the pastEnd position, false otherwise.
-template <typename ValueType>
-bool DoublyLinkedList<ValueType>::IteratorBase::isPastEnd() const noexcept
+// Rotating right by count is rotating left by the rest of the list.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::rotateRight(unsigned int count) noexcept
 {
-    return pastEnd;
-}
-
+    if (sz == 0)
+    {
+        return;
+    }
 
-// ConstIterator constructor taking in the DLL.
-template <typename ValueType>
-DoublyLinkedList<ValueType>::ConstIterator::ConstIterator(const DoublyLinkedList& list) noexcept
-    : IteratorBase{list}
-{
+    rotateLeft(sz - count % sz);
 }
 
 
-// Returns the value of the current position in the ConstIterator.
-template <typename ValueType>
-const ValueType& DoublyLinkedList<ValueType>::ConstIterator::value() const
+// Unlinks the iterator's node and links it back in before the head.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::moveToFront(const Iterator& iterator)
 {
-    if (this->pastStart == true || this->pastEnd == true || this->currentNode == nullptr)
+    if (iterator.itList != this || iterator.pastStart == true || iterator.pastEnd == true)
     {
         throw IteratorException{};
     }
-    else
+
+    Node* node = iterator.currentNode;
+
+    if (node == head)
     {
-        return this->currentNode->value;
+        return;
     }
-}
 
+    unlinkNode(node);
 
-// Iterator constructor taking in the DLL.
-template <typename ValueType>
-DoublyLinkedList<ValueType>::Iterator::Iterator(DoublyLinkedList& list) noexcept
-    : IteratorBase{list}
-{
+    node->prev = nullptr;
+    node->next = head;
+    head->prev = node;
+    head = node;
+    sz++;
 }
 
 
-// Returns the value of the current position of Iterator.
-template <typename ValueType>
-ValueType& DoublyLinkedList<ValueType>::Iterator::value() const
+// Unlinks the iterator's node and links it back in after the tail.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::moveToBack(const Iterator& iterator)
 {
-    if (this->pastStart == true || this->pastEnd == true || this->currentNode == nullptr)
+    if (iterator.itList != this || iterator.pastStart == true || iterator.pastEnd == true)
     {
         throw IteratorException{};
     }
-    else
+
+    Node* node = iterator.currentNode;
+
+    if (node == tail)
     {
-        return this->currentNode->value;
+        return;
     }
+
+    unlinkNode(node);
+
+    node->next = nullptr;
+    node->prev = tail;
+    tail->next = node;
+    tail = node;
+    sz++;
 }
 
 
-// Inserts new node before current position.
-// Increases size of DLL by 1.
-// DOES NOT move current position / currentNode .
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::Iterator::insertBefore(const ValueType& value)
+// Swaps every node's prev and next pointers, then swaps head and tail.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::reverse() noexcept
 {
-    // If current position is nullptr before head.
-    if (this->pastStart == true && this->currentNode == nullptr)
+    for (Node* currentNode = head; currentNode != nullptr; currentNode = currentNode->prev) // prev is the old next.
     {
-        throw IteratorException{};
+        std::swap(currentNode->prev, currentNode->next);
     }
-    // If current position IS head.
-    else if (this->currentNode == this->itHead)
+
+    std::swap(head, tail);
+    hashValid = false;
+}
+
+
+// Returns the value of the head (first node) that CANNOT change or be modified.
+template <typename ValueType, typename NodeStorage>
+const ValueType& DoublyLinkedList<ValueType, NodeStorage>::first() const
+{
+    if (sz == 0)
     {
-        Node* insertedNode = new Node{value, nullptr, this->itHead};
-        this->itHead->prev = insertedNode;
+        throw EmptyException{};
+    }
+    else
+    {
+        return head->value;
+    } 
+}
 
-        // Repoint head to insertedNode.
-        this->itHead = insertedNode;
+// Returns the value of the head (first node) that CAN change or be modified.
+template <typename ValueType, typename NodeStorage>
+ValueType& DoublyLinkedList<ValueType, NodeStorage>::first()
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
     }
-    // If current position is nullptr after tail.
-    else if (this->pastEnd == true && this->currentNode == nullptr)
+    else
     {
-        Node* insertedNode = new Node{value, this->itTail, nullptr};
-        this->itTail->next = insertedNode;
+        hashValid = false;
+        return head->value;
+    } 
+}
 
-        // Repoint tail to insertedNode.
-        this->itTail = insertedNode;
 
-        // PastEnd remains true.
+// Returns the value of the last (last node) that CANNOT change or be modified.
+template <typename ValueType, typename NodeStorage>
+const ValueType& DoublyLinkedList<ValueType, NodeStorage>::last() const
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
     }
     else
     {
-        Node* insertedNode = new Node{value, this->currentNode->prev, this->currentNode};
+        return tail->value;
+    } 
+}
 
-        Node* nodeBeforeInsert = this->currentNode->prev;
-        nodeBeforeInsert->next = insertedNode;
 
-        this->currentNode->prev = insertedNode;
+// Returns the value of the last (last node) that CAN change or be modified.
+template <typename ValueType, typename NodeStorage>
+ValueType& DoublyLinkedList<ValueType, NodeStorage>::last()
+{
+    if (sz == 0)
+    {
+        throw EmptyException{};
     }
-    this->itSize++;
+    else
+    {
+        hashValid = false;
+        return tail->value;
+    } 
+}
+
+// Returns the size of the DLL that is modified in the DLL class and IteratorBase with its derived iterator classes.
+template <typename ValueType, typename NodeStorage>
+unsigned int DoublyLinkedList<ValueType, NodeStorage>::size() const noexcept
+{
+    return sz;
 }
 
 
-// Inserts new node after current position.
-// Increases size of DLL by 1.
-// DOES NOT move current position / currentNode.
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::Iterator::insertAfter(const ValueType& value)
+// Adds up the nodes, the values inside them, and what's left over.
+template <typename ValueType, typename NodeStorage>
+MemoryFootprint DoublyLinkedList<ValueType, NodeStorage>::memoryFootprint() const noexcept
 {
-    // If current position is nullptr after tail.
-    if (this->pastEnd == true && this->currentNode == nullptr)
+    MemoryFootprint footprint{};
+
+    footprint.nodeBytes = sz * sizeof(Node);
+    footprint.payloadBytes = sz * sizeof(ValueType);
+    footprint.overheadBytes = (footprint.nodeBytes - footprint.payloadBytes) + sizeof(DoublyLinkedList);
+    footprint.reservedUnusedBytes = NodeStorage::template reservedUnusedBytes<sizeof(Node), alignof(Node)>()
+                                    + spareCount * sizeof(Node);
+
+    return footprint;
+}
+
+
+// Returns true of list is empty, false if not empty.
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::isEmpty() const noexcept
+{
+    if (head == nullptr && tail == nullptr && sz == 0)
     {
-        throw IteratorException{};
+        return true;
     }
-    // If current position IS tail, insertedNode becomes new tail.
-    else if (this->currentNode == this->itTail && this->pastEnd == false)
+    else
     {
-        Node* insertedNode = new Node{value, this->itTail, nullptr};
-        this->itTail->next = insertedNode;
+        return false;
+    }
+}
 
-        // Repoint tail to insertedNode.
-        this->itTail = insertedNode;
 
-        // // No longer necessary since size counts the nodes when
-        // // the member function .size() is called.
-        // //update size
-        // itSize++;
+// Takes a spare node or allocates one, and reports it.
+template <typename ValueType, typename NodeStorage>
+template <typename... Args>
+typename DoublyLinkedList<ValueType, NodeStorage>::Node* DoublyLinkedList<ValueType, NodeStorage>::createNode(Args&&... args)
+{
+    void* block = spareNodes;
+    Node* node;
+
+    if (block != nullptr)
+    {
+        spareNodes = static_cast<NodeChainLink*>(block)->next;
+        spareCount--;
     }
-    // If current position is nullptr before head.
-    else if (this->pastStart == true && this->currentNode == nullptr)
+    else
+    {
+        block = NodeStorage::template allocate<sizeof(Node), alignof(Node)>();
+    }
+
+    try
+    {
+        node = new (block) Node{std::forward<Args>(args)...};
+    }
+    // If the value can't be constructed, give the memory back (even if it was a spare) before re-throwing.
+    catch(...)
     {
-        Node* insertedNode = new Node{value, nullptr, this->itHead};
-        this->itHead->prev = insertedNode;
+        NodeStorage::template deallocate<sizeof(Node), alignof(Node)>(block);
+        throw;
+    }
+
+    trackAllocation(sizeof(Node));
+    return node;
+}
+
+
+// Deallocates a node and reports it.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::destroyNode(Node* node) noexcept
+{
+    node->~Node();
+    NodeStorage::template deallocate<sizeof(Node), alignof(Node)>(node);
+    trackDeallocation(sizeof(Node));
+}
+
+
+// Destroys nodes from first to tail, reading each next pointer before its node is destroyed
+// and leaving a NodeChainLink to the next node in its place, and deallocates them a chain of
+// NodeStorage::nodesPerChain at a time.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::destroyNodes(Node* first) noexcept
+{
+    while (first != nullptr)
+    {
+        Node* currentNode = first;
+        Node* lastNode = nullptr;
+        std::size_t count = 0;
+
+        while (currentNode != nullptr && count < NodeStorage::nodesPerChain)
+        {
+            Node* nextNode = currentNode->next;
+            count++;
 
-        // Repoint tail to insertedNode.
-        this->itHead = insertedNode;
+            currentNode->~Node();
+            new (currentNode) NodeChainLink{count < NodeStorage::nodesPerChain ? nextNode : nullptr};
 
-        // PastStart remains true.
+            lastNode = currentNode;
+            currentNode = nextNode;
+        }
+
+        NodeStorage::template deallocateChain<sizeof(Node), alignof(Node)>(first, lastNode, count);
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            trackDeallocation(sizeof(Node));
+        }
+
+        first = currentNode;
+    }
+}
+
+
+// Copies nodes from first to tail into a new chain, cleaning up if anything throws.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::copyNodes(const Node* first, Node*& newHead, Node*& newTail)
+{
+    newHead = newTail = nullptr;
+
+    try
+    {
+        for (const Node* listCurrentNode = first; listCurrentNode != nullptr; listCurrentNode = listCurrentNode->next)
+        {
+            Node* newNode = createNode(listCurrentNode->value, newTail, nullptr); // Link back.
+
+            if (newTail == nullptr)
+            {
+                newHead = newNode;
+            }
+            else
+            {
+                newTail->next = newNode; // Link forward.
+            }
+
+            newTail = newNode;
+        }
+    }
+    // Catch exception/error, deallocate memory (to avoid memory leak), then re-throw exception/error.
+    catch(...)
+    {
+        destroyNodes(newHead);
+        newHead = newTail = nullptr;
+        throw;
+    }
+}
+
+
+// Links a new node in before position (or after the tail when position is nullptr).
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::Node* DoublyLinkedList<ValueType, NodeStorage>::insertNodeBefore(Node* position, const ValueType& value)
+{
+    Node* nodeBefore = (position == nullptr) ? tail : position->prev;
+    Node* insertedNode = createNode(value, nodeBefore, position);
+
+    if (nodeBefore == nullptr)
+    {
+        head = insertedNode;
     }
     else
     {
-        Node* insertedNode = new Node{value, this->currentNode, this->currentNode->next};
+        nodeBefore->next = insertedNode;
+    }
+
+    if (position == nullptr)
+    {
+        tail = insertedNode;
+    }
+    else
+    {
+        position->prev = insertedNode;
+    }
+
+    sz++;
+    hashValid = false;
+    return insertedNode;
+}
+
 
-        Node* nodeAfterInsert = this->currentNode->next;
-        nodeAfterInsert->prev = insertedNode;
+// Links the neighbours of node to each other (or repoints head/tail) and takes it out of the count.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::unlinkNode(Node* node) noexcept
+{
+    if (node->prev == nullptr)
+    {
+        head = node->next;
+    }
+    else
+    {
+        node->prev->next = node->next;
+    }
 
-        this->currentNode->next = insertedNode;
+    if (node->next == nullptr)
+    {
+        tail = node->prev;
     }
-    this->itSize++;
+    else
+    {
+        node->next->prev = node->prev;
+    }
+
+    sz--;
+    hashValid = false;
 }
 
 
-// Removes a node and redetermines/updates head and tail pointers if neccesary.
-// Decrease size of DLL by -1.
-// Possible for currentNode to enter the pastStart or pastEnd position (aka nullptr).
-template <typename ValueType>
-void DoublyLinkedList<ValueType>::Iterator::remove(bool moveToNextAfterward)
+// Construct constant iterator already referring to node.
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::ConstIterator DoublyLinkedList<ValueType, NodeStorage>::constIteratorAt(const Node* node) const noexcept
 {
-    if (this->pastStart == true || this->pastEnd == true)
+    ConstIterator iterator{*this};
+
+    if (node == nullptr)
     {
-        throw IteratorException{};
+        iterator.currentNode = nullptr;
+        iterator.pastStart = (head == nullptr);
+        iterator.pastEnd = true;
+    }
+    else
+    {
+        iterator.currentNode = const_cast<Node*>(node);
+    }
+
+    return iterator;
+}
+
+
+// Calls function with each value (that CANNOT be modified) from head to tail.
+template <typename ValueType, typename NodeStorage>
+template <typename Function>
+void DoublyLinkedList<ValueType, NodeStorage>::forEach(Function function) const
+{
+    for (const Node* currentNode = head; currentNode != nullptr; currentNode = currentNode->next)
+    {
+        function(currentNode->value);
+    }
+}
+
+
+// Calls function with each value (that CAN be modified) from head to tail.
+template <typename ValueType, typename NodeStorage>
+template <typename Function>
+void DoublyLinkedList<ValueType, NodeStorage>::forEach(Function function)
+{
+    hashValid = false;
+
+    for (Node* currentNode = head; currentNode != nullptr; currentNode = currentNode->next)
+    {
+        function(currentNode->value);
+    }
+}
+
+
+// Reallocates every node in list order so that the nodes sit close together in memory.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::relayout()
+{
+    // Values are only moved when both moving them out and (if something fails) moving them back can't throw.
+    constexpr bool moveValues = std::is_nothrow_move_constructible<ValueType>::value
+                                && std::is_nothrow_move_assignable<ValueType>::value;
+
+    // Spare nodes are wherever the old nodes were, so reusing them would undo the point of this.
+    releaseSpareNodes();
+
+    // Nothing can be gained by reallocating zero or one node.
+    if (sz < 2)
+    {
+        return;
+    }
+
+    Node* newHead = nullptr;
+    Node* newTail = nullptr;
+
+    try
+    {
+        for (Node* oldNode = head; oldNode != nullptr; oldNode = oldNode->next)
+        {
+            Node* newNode;
+
+            if constexpr (moveValues)
+            {
+                newNode = createNode(std::move(oldNode->value), newTail, nullptr);
+            }
+            else
+            {
+                newNode = createNode(oldNode->value, newTail, nullptr);
+            }
+
+            if (newTail == nullptr)
+            {
+                newHead = newNode;
+            }
+            else
+            {
+                newTail->next = newNode; // Link forward.
+            }
+
+            newTail = newNode;
+        }
     }
-    else if (moveToNextAfterward == true) // So move after.
+    // Catch exception/error, put back what was moved out, deallocate the new nodes, then re-throw.
+    catch(...)
     {
-        if (this->currentNode == this->itHead)
+        Node* oldNode = head;
+
+        while (newHead != nullptr)
         {
-            Node* tempNode = this->currentNode; // Point to original head position to delete later.
-            this->currentNode = this->currentNode->next; // Repoint to node after head.
-            this->currentNode->prev = nullptr; // Update for prev to point at pastStart / nullptr.
-            this->itHead = this->currentNode; // Repoint to "new" head node.
+            if constexpr (moveValues)
+            {
+                oldNode->value = std::move(newHead->value);
+                oldNode = oldNode->next;
+            }
 
-            delete tempNode; // Delete the original head   .
+            Node* tempNode = newHead;
+            newHead = newHead->next;
+            destroyNode(tempNode);
         }
-        else if (this->currentNode == this->itTail) // Will delete tail node and point to nullptr.
+        throw;
+    }
+
+    // Delete the original nodes now that their values live in the new ones.
+    destroyNodes(head);
+
+    head = newHead;
+    tail = newTail;
+}
+
+
+// Sizes are compared first, so lists that can't be equal are usually told apart in constant time.
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator==(const DoublyLinkedList& list) const
+{
+    if (sz != list.sz)
+    {
+        return false;
+    }
+    else if (this == &list)
+    {
+        return true;
+    }
+
+    for (const Node* thisNode = head, * listNode = list.head; thisNode != nullptr; thisNode = thisNode->next, listNode = listNode->next)
+    {
+        if ((thisNode->value == listNode->value) == false)
         {
-            this->currentNode = this->currentNode->prev; // Go backwards to delete current / tail node.
-            delete this->currentNode->next; // Delete original tail node.
-            this->itTail = this->currentNode; // Tail now refers to "new" tail.
-            this->currentNode->next = nullptr; // Update the next pointer of new tail node.
-            this->currentNode = nullptr; // Current position is now pastEnd / correct position.
-            
-            this->pastEnd = true; // Update pastEnd to true because currentNode now points to nullptr after tail.
+            return false;
         }
-        // node is right before tail
-        else if (this->currentNode->next == this->itTail) 
+    }
+
+    return true;
+}
+
+
+#if __cplusplus >= 202002L
+// Walks both lists to the first pair of values that differ; if there isn't one, the shorter list comes first.
+template <typename ValueType, typename NodeStorage>
+auto DoublyLinkedList<ValueType, NodeStorage>::operator<=>(const DoublyLinkedList& list) const
+{
+    using Ordering = decltype(compareValues(std::declval<const ValueType&>(), std::declval<const ValueType&>()));
+
+    for (const Node* thisNode = head, * listNode = list.head; thisNode != nullptr && listNode != nullptr; thisNode = thisNode->next, listNode = listNode->next)
+    {
+        Ordering ordering = compareValues(thisNode->value, listNode->value);
+
+        if (ordering != 0)
         {
-            this->currentNode = this->currentNode->prev; // Go backwards to delete current.
-            delete this->currentNode->next; // Delete original tail node.
-            this->currentNode->next = this->itTail;  // Tail should still have same value and same next (nullptr).
-            this->itTail->prev = this->currentNode;
+            return ordering;
+        }
+    }
+
+    return static_cast<Ordering>(sz <=> list.sz);
+}
+
 
-            this->currentNode = this->itTail;  
+// Uses the values' own operator<=> when there is one, and builds a weak ordering out of operator< otherwise.
+template <typename ValueType, typename NodeStorage>
+auto DoublyLinkedList<ValueType, NodeStorage>::compareValues(const ValueType& first, const ValueType& second)
+{
+    if constexpr (std::three_way_comparable<ValueType>)
+    {
+        return first <=> second;
+    }
+    else
+    {
+        if (first < second)
+        {
+            return std::weak_ordering::less;
+        }
+        else if (second < first)
+        {
+            return std::weak_ordering::greater;
         }
-        // If currentNode is the last node in the DLL.
-        else if (this->currentNode->prev == nullptr && this->currentNode->next == nullptr)
+        else
         {
-            delete this->currentNode;
-            this->currentNode = this->itHead = this->itTail = nullptr;
-            this->pastStart = true;
-            this->pastEnd = true;
+            return std::weak_ordering::equivalent;
+        }
+    }
+}
+#else
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator!=(const DoublyLinkedList& list) const
+{
+    return (*this == list) == false;
+}
 
-            //update size?
+
+// Walks both lists to the first pair of values that differ; if there isn't one, the shorter list comes first.
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator<(const DoublyLinkedList& list) const
+{
+    for (const Node* thisNode = head, * listNode = list.head; thisNode != nullptr && listNode != nullptr; thisNode = thisNode->next, listNode = listNode->next)
+    {
+        if (thisNode->value < listNode->value)
+        {
+            return true;
+        }
+        else if (listNode->value < thisNode->value)
+        {
+            return false;
         }
-        else // Remove a body node if size > 1 since size == 1 is taken care of.
+    }
+
+    return sz < list.sz;
+}
+
+
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator>(const DoublyLinkedList& list) const
+{
+    return list < *this;
+}
+
+
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator<=(const DoublyLinkedList& list) const
+{
+    return (list < *this) == false;
+}
+
+
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::operator>=(const DoublyLinkedList& list) const
+{
+    return (*this < list) == false;
+}
+#endif
+
+
+// Walks the list to build the hash the first time, then returns the cached one; mixing in
+// the size keeps lists of values that hash to 0 (such as 0 itself) apart from each other.
+template <typename ValueType, typename NodeStorage>
+std::size_t DoublyLinkedList<ValueType, NodeStorage>::hash() const
+{
+    static_assert(std::is_default_constructible<std::hash<ValueType>>::value,
+                  "hash() needs a std::hash specialization for the values in the list");
+
+    if (hashValid == false)
+    {
+        std::size_t newHash = 0;
+        std::size_t newPower = 1;
+
+        for (const Node* currentNode = head; currentNode != nullptr; currentNode = currentNode->next)
         {
-            Node* nodeBefore = this->currentNode->prev;
-            Node* nodeAfter = this->currentNode->next;
-            
-            delete this->currentNode;
-            nodeBefore->next = nodeAfter;
-            nodeAfter->prev = nodeBefore;
-
-            this->currentNode = nodeAfter;
+            newHash = newHash * hashMultiplier + std::hash<ValueType>{}(currentNode->value);
+            newPower *= hashMultiplier;
         }
+
+        cachedHash = newHash;
+        hashPower = newPower;
+        hashValid = true;
     }
-    else if (moveToNextAfterward == false) // So move before.
+
+    return cachedHash ^ static_cast<std::size_t>(sz);
+}
+
+
+// Adds or takes away one term at either end of the polynomial (see cachedHash), keeping hashPower
+// equal to hashMultiplier raised to the power of the number of values in the list.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::updateCachedHash(const ValueType& value, bool atEnd, bool added) const noexcept
+{
+    if constexpr (std::is_default_constructible<std::hash<ValueType>>::value)
     {
-        if (this->currentNode == this->itHead)
+        if (hashValid == false)
         {
-            this->currentNode = this->currentNode->next; 
-            delete this->currentNode->prev; // Same as delete itHead.
-            this->currentNode->prev = nullptr; // prev now points to nullptr.
-            this->currentNode = this->currentNode->prev; // Same as nullptr.
-            this->itHead = this->currentNode; // Repoint head node.
-
-            this->pastStart = true;
-            this->pastEnd = false;
+            return;
         }
-        else if (this->currentNode == this->itTail) // Will delete tail node and point to node before original tail.
+
+        std::size_t valueHash;
+
+        try
         {
-            this->currentNode = this->currentNode->prev; // Go backwards to delete current / tail node.
-            delete this->currentNode->next; // Delete original tail node.
-            this->currentNode->next = nullptr; 
-            this->itTail = this->currentNode; // Tail now refers to "new" tail.
-            
-            this->pastEnd = false; // Update pastEnd to true because currentNode now points to nullptr after tail.
+            valueHash = std::hash<ValueType>{}(value);
         }
-        // Node is right before head.
-        else if (this->currentNode->prev == this->itHead) 
+        catch(...)
         {
-            this->currentNode = this->currentNode->next; 
-            delete this->currentNode->prev;
-            this->currentNode->prev = this->itHead;
-            this->itHead->next = this->currentNode;
+            hashValid = false;
+            return;
+        }
 
-            this->currentNode = this->itHead; 
+        if (added == true && atEnd == true) // Every other term moves up a power.
+        {
+            cachedHash = cachedHash * hashMultiplier + valueHash;
+            hashPower *= hashMultiplier;
+        }
+        else if (added == true) // The new term is the highest one.
+        {
+            cachedHash += valueHash * hashPower;
+            hashPower *= hashMultiplier;
         }
-        // If currentNode is the last node in the DLL.
-        else if (this->currentNode->prev == nullptr && this->currentNode->next == nullptr)
+        else if (atEnd == true) // Every other term moves down a power.
         {
-            delete this->currentNode;
-            this->currentNode = this->itHead = this->itTail = nullptr;
-            this->pastStart = true;
-            this->pastEnd = true;
+            cachedHash = (cachedHash - valueHash) * inverseHashMultiplier();
+            hashPower *= inverseHashMultiplier();
         }
-        else // Remove a body node if size > 1 since size == 1 is taken care of.
+        else // The removed term was the highest one.
         {
-            Node* nodeBefore = this->currentNode->prev;
-            Node* nodeAfter = this->currentNode->next;
-            
-            delete this->currentNode;
-            nodeBefore->next = nodeAfter;
-            nodeAfter->prev = nodeBefore;
-
-            this->currentNode = nodeBefore;
+            hashPower *= inverseHashMultiplier();
+            cachedHash -= valueHash * hashPower;
         }
     }
-    this->itSize--;
+    else
+    {
+        (void)value;
+        (void)atEnd;
+        (void)added;
+    }
 }
 
+
+// Newton's iteration for the inverse modulo 2^N: each step doubles the number of correct low bits,
+// and hashMultiplier is its own inverse modulo 8, so five steps are enough for 64 bits.
+template <typename ValueType, typename NodeStorage>
+constexpr std::size_t DoublyLinkedList<ValueType, NodeStorage>::inverseHashMultiplier()
+{
+    std::size_t inverse = hashMultiplier;
+
+    for (int i = 0; i < 5; i++)
+    {
+        inverse *= 2 - hashMultiplier * inverse;
+    }
+
+    return inverse;
+}
+
+
+//
+// Iterator member functions //
+//
+
+
+// Construct modifiable iterator.
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::Iterator DoublyLinkedList<ValueType, NodeStorage>::iterator()
+{
+    return Iterator{*this};
+}
+
+
+// Construct constant iterator.
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::ConstIterator DoublyLinkedList<ValueType, NodeStorage>::constIterator() const
+{
+    return ConstIterator{*this};
+}
+
+
+// Construct modifiable iterator starting at the tail.
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::Iterator DoublyLinkedList<ValueType, NodeStorage>::iteratorAtEnd()
+{
+    return Iterator{*this, true};
+}
+
+
+// Construct constant iterator starting at the tail.
+template <typename ValueType, typename NodeStorage>
+typename DoublyLinkedList<ValueType, NodeStorage>::ConstIterator DoublyLinkedList<ValueType, NodeStorage>::constIteratorAtEnd() const
+{
+    return ConstIterator{*this, true};
+}
+
+
+// Class that Iterator and ConstIterator derives from using the DLL.
+// The iterator refers to the list itself rather than copies of its head, tail and size,
+// so that changes made through one iterator (or the list) are seen by every other one.
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::IteratorBase::IteratorBase(const DoublyLinkedList& list, bool startAtLast) noexcept
+{
+    // Only Iterator, which is handed a non-const list, ever modifies the list through this.
+    itList = const_cast<DoublyLinkedList*>(&list);
+
+    // If list is empty.
+    if (itList->head == nullptr)
+    {
+        currentNode = nullptr;
+        pastStart = true;
+        pastEnd = true;
+    }
+    // If list is NOT empty.
+    else // Refer to the first value in the list, or the last one if asked.
+    {
+        pastStart = false;
+        pastEnd = false;
+
+        currentNode = startAtLast ? itList->tail : itList->head;
+    }
+}
+
+
+// Current position moves to next node towards tail.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::IteratorBase::moveToNext()
+{
+    // If current position is nullptr after tail (which includes an empty list).
+    if (pastEnd == true)
+    {
+        throw IteratorException{};
+    }
+
+    // From nullptr before head, move to head; otherwise follow the next pointer.
+    currentNode = (pastStart == true) ? itList->head : currentNode->next;
+
+    // If current position WAS the tail, it is now nullptr and pastEnd.
+    pastStart = false;
+    pastEnd = (currentNode == nullptr);
+}
+
+
+// Current position moves to next node towards head.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::IteratorBase::moveToPrevious()
+{
+    // If current position is nullptr before head (which includes an empty list).
+    if (pastStart == true)
+    {
+        throw IteratorException{};
+    }
+
+    // From nullptr after tail, move to tail; otherwise follow the prev pointer.
+    currentNode = (pastEnd == true) ? itList->tail : currentNode->prev;
+
+    // If current position WAS the head, it is now nullptr and pastStart.
+    pastEnd = false;
+    pastStart = (currentNode == nullptr);
+}
+
+
+// Returns true if the current position is in the pastStart position, false otherwise.
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::IteratorBase::isPastStart() const noexcept
+{
+    return pastStart;
+}
+
+
+// Returns true if the current position is in the pastEnd position, false otherwise.
+template <typename ValueType, typename NodeStorage>
+bool DoublyLinkedList<ValueType, NodeStorage>::IteratorBase::isPastEnd() const noexcept
+{
+    return pastEnd;
+}
+
+
+// ConstIterator constructor taking in the DLL.
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::ConstIterator::ConstIterator(const DoublyLinkedList& list, bool startAtLast) noexcept
+    : IteratorBase{list, startAtLast}
+{
+}
+
+
+// Returns the value of the current position in the ConstIterator.
+template <typename ValueType, typename NodeStorage>
+const ValueType& DoublyLinkedList<ValueType, NodeStorage>::ConstIterator::value() const
+{
+    if (this->pastStart == true || this->pastEnd == true || this->currentNode == nullptr)
+    {
+        throw IteratorException{};
+    }
+    else
+    {
+        return this->currentNode->value;
+    }
+}
+
+
+// Iterator constructor taking in the DLL.
+// Values can be changed through value(), so the list's cached hash can't be trusted from here on.
+template <typename ValueType, typename NodeStorage>
+DoublyLinkedList<ValueType, NodeStorage>::Iterator::Iterator(DoublyLinkedList& list, bool startAtLast) noexcept
+    : IteratorBase{list, startAtLast}
+{
+    list.hashValid = false;
+}
+
+
+// Returns the value of the current position of Iterator.
+template <typename ValueType, typename NodeStorage>
+ValueType& DoublyLinkedList<ValueType, NodeStorage>::Iterator::value() const
+{
+    if (this->pastStart == true || this->pastEnd == true || this->currentNode == nullptr)
+    {
+        throw IteratorException{};
+    }
+    else
+    {
+        return this->currentNode->value;
+    }
+}
+
+
+// Inserts new node before current position.
+// Increases size of DLL by 1.
+// DOES NOT move current position / currentNode.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::Iterator::insertBefore(const ValueType& value)
+{
+    DOUBLYLINKEDLIST_TRACE("Iterator::insertBefore");
+
+    // If current position is nullptr before head.
+    if (this->pastStart == true)
+    {
+        throw IteratorException{};
+    }
+
+    // From nullptr after tail (currentNode is nullptr), this inserts a new tail and pastEnd remains true.
+    this->itList->insertNodeBefore(this->currentNode, value);
+}
+
+
+// Inserts new node after current position.
+// Increases size of DLL by 1.
+// DOES NOT move current position / currentNode.
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::Iterator::insertAfter(const ValueType& value)
+{
+    DOUBLYLINKEDLIST_TRACE("Iterator::insertAfter");
+
+    // If current position is nullptr after tail.
+    if (this->pastEnd == true)
+    {
+        throw IteratorException{};
+    }
+
+    // From nullptr before head, this inserts a new head and pastStart remains true.
+    Node* nodeAfterInsert = (this->pastStart == true) ? this->itList->head : this->currentNode->next;
+    this->itList->insertNodeBefore(nodeAfterInsert, value);
+}
+
+
+// Removes a node and redetermines/updates head and tail pointers if neccesary.
+// Decrease size of DLL by -1.
+// Possible for currentNode to enter the pastStart or pastEnd position (aka nullptr).
+template <typename ValueType, typename NodeStorage>
+void DoublyLinkedList<ValueType, NodeStorage>::Iterator::remove(bool moveToNextAfterward)
+{
+    DOUBLYLINKEDLIST_TRACE("Iterator::remove");
+
+    if (this->pastStart == true || this->pastEnd == true)
+    {
+        throw IteratorException{};
+    }
+
+    Node* nodeBefore = this->currentNode->prev;
+    Node* nodeAfter = this->currentNode->next;
+
+    this->itList->unlinkNode(this->currentNode);
+    destroyNode(this->currentNode);
+
+    if (moveToNextAfterward == true) // So move after; removing the tail leaves us pastEnd.
+    {
+        this->currentNode = nodeAfter;
+        this->pastEnd = (nodeAfter == nullptr);
+    }
+    else // So move before; removing the head leaves us pastStart.
+    {
+        this->currentNode = nodeBefore;
+        this->pastStart = (nodeBefore == nullptr);
+    }
+
+    // If that was the last node in the DLL, we are both pastStart and pastEnd.
+    if (this->itList->head == nullptr)
+    {
+        this->pastStart = true;
+        this->pastEnd = true;
+    }
+}
+
+
+namespace DoublyLinkedListDetails
+{
+    // The std::hash of a list whose values can't be hashed is "disabled", like
+    // std::hash of any other type without one: it can't be constructed, so
+    // traits such as std::is_default_constructible report it as unusable.
+    template <typename ListType, bool ValuesAreHashable>
+    struct ListHash
+    {
+        ListHash() = delete;
+        ListHash(const ListHash&) = delete;
+        ListHash& operator=(const ListHash&) = delete;
+    };
+
+
+    template <typename ListType>
+    struct ListHash<ListType, true>
+    {
+        std::size_t operator()(const ListType& list) const
+        {
+            return list.hash();
+        }
+    };
+}
+
+
+// std::hash of a DoublyLinkedList is its hash(), so that lists can be used as keys in
+// std::unordered_map and std::unordered_set.  Like hash(), it stores its result in the
+// list, so the same list must not be hashed from two threads at once, even when it is
+// const (for example, while it is a key being looked up from several threads).
+namespace std
+{
+    template <typename ValueType, typename NodeStorage>
+    struct hash<DoublyLinkedList<ValueType, NodeStorage>>
+        : DoublyLinkedListDetails::ListHash<DoublyLinkedList<ValueType, NodeStorage>,
+                                            std::is_default_constructible<std::hash<ValueType>>::value>
+    {
+    };
+}
+
+
 #endif
 
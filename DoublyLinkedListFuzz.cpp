@@ -0,0 +1,589 @@
+// DoublyLinkedListFuzz.cpp
+// A differential fuzzer for DoublyLinkedList and XorLinkedList, and a
+// replay benchmark that fails when DoublyLinkedList's throughput regresses.
+//
+// Every input is read as a sequence of operations (see runOperations()),
+// which are applied both to a DoublyLinkedList<int> and to a std::list<int>
+// kept alongside it.  After each operation the two must hold the same
+// values, walking forward and backward, with the same size(), first() and
+// last(), and an iterator moved around by the operations must agree with
+// its position in the std::list.  Any difference aborts the program.  The
+// same input is then run against an XorLinkedList<int>, whose iterators
+// have to carry the node before their own, the same way; operations that
+// XorLinkedList doesn't have (splicing, relayout, rotation, reversal and
+// moving values to either end) are skipped for it.
+//
+// With libFuzzer (which supplies its own main()):
+//
+//     clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined -DDOUBLYLINKEDLIST_LIBFUZZER DoublyLinkedListFuzz.cpp -o fuzz
+//     ./fuzz
+//
+// Standalone, under the sanitizers:
+//
+//     g++ -std=c++17 -g -O1 -fsanitize=address,undefined DoublyLinkedListFuzz.cpp -o fuzz
+//     ./fuzz                       runs 10000 random inputs
+//     ./fuzz --random 1000000      runs that many random inputs
+//     ./fuzz crash-1234 ...        runs the given input files
+//
+// As a performance regression gate, built with optimizations:
+//
+//     g++ -std=c++17 -O2 DoublyLinkedListFuzz.cpp -o fuzz
+//     ./fuzz --record trace.bin 10000000
+//     ./fuzz --replay trace.bin baseline.txt 0.15
+//
+// --record writes a trace of that many random operations.  --replay runs
+// the trace against the DoublyLinkedList alone (without the std::list or
+// any checking) a few times and takes its best throughput.  If the
+// baseline file doesn't exist yet, the throughput is written to it;
+// otherwise the program fails if the throughput is lower than the
+// baseline by more than the given fraction (by default 0.15, since runs
+// on a busy machine vary by about 10%).  Baselines are only comparable on
+// the same machine, so they are not kept in the repository.
+
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "DoublyLinkedList.hpp"
+#include "XorLinkedList.hpp"
+
+
+
+namespace
+{
+    // Every operation is an opcode byte followed by two bytes of argument.
+    constexpr std::size_t operationBytes = 3;
+    constexpr unsigned int operationCount = 19;
+
+
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "DoublyLinkedListFuzz: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    // Runs a function that is expected to throw the given exception.
+    template <typename Exception, typename Function>
+    void requireThrow(Function function, const char* what)
+    {
+        bool thrown = false;
+
+        try
+        {
+            function();
+        }
+        catch (Exception&)
+        {
+            thrown = true;
+        }
+
+        require(thrown, what);
+    }
+
+
+    // Compares the list to the reference: forward, backward, size, first() and last().
+    template <typename List>
+    void checkContents(const List& list, const std::list<int>& reference)
+    {
+        require(list.size() == reference.size(), "size() differs");
+        require(list.isEmpty() == reference.empty(), "isEmpty() differs");
+
+        std::list<int>::const_iterator expected = reference.begin();
+
+        for (typename List::ConstIterator iterator = list.constIterator(); iterator.isPastEnd() == false; iterator.moveToNext())
+        {
+            require(expected != reference.end(), "forward traversal is too long");
+            require(iterator.value() == *expected, "forward traversal differs");
+            ++expected;
+        }
+
+        require(expected == reference.end(), "forward traversal is too short");
+
+        std::list<int>::const_reverse_iterator expectedBackward = reference.rbegin();
+
+        for (typename List::ConstIterator iterator = list.constIteratorAtEnd(); iterator.isPastStart() == false; iterator.moveToPrevious())
+        {
+            require(expectedBackward != reference.rend(), "reverse traversal is too long");
+            require(iterator.value() == *expectedBackward, "reverse traversal differs");
+            ++expectedBackward;
+        }
+
+        require(expectedBackward == reference.rend(), "reverse traversal is too short");
+
+        if (reference.empty() == true)
+        {
+            requireThrow<EmptyException>([&list]() { list.first(); }, "first() of an empty list didn't throw");
+            requireThrow<EmptyException>([&list]() { list.last(); }, "last() of an empty list didn't throw");
+        }
+        else
+        {
+            require(list.first() == reference.front(), "first() differs");
+            require(list.last() == reference.back(), "last() differs");
+        }
+    }
+
+
+    // Checks that the iterator is at the given position of the reference,
+    // where -1 is "past start" and the size of the reference is "past end".
+    template <typename List>
+    void checkIterator(const typename List::Iterator& iterator, const std::list<int>& reference, long position)
+    {
+        long size = static_cast<long>(reference.size());
+
+        if (size == 0)
+        {
+            require(iterator.isPastStart() && iterator.isPastEnd(), "iterator over an empty list isn't past both ends");
+        }
+        else if (position == -1)
+        {
+            require(iterator.isPastStart() && iterator.isPastEnd() == false, "iterator should be past start");
+        }
+        else if (position == size)
+        {
+            require(iterator.isPastEnd() && iterator.isPastStart() == false, "iterator should be past end");
+        }
+        else
+        {
+            require(iterator.isPastStart() == false && iterator.isPastEnd() == false, "iterator should refer to a value");
+            require(iterator.value() == *std::next(reference.begin(), position), "iterator refers to the wrong value");
+        }
+    }
+
+
+    // Applies the operations in data to a list.  When check is true, they
+    // are also applied to a std::list and the two are compared after every
+    // operation; otherwise only the list is touched, for timing.
+    template <typename List>
+    void runOperations(const std::uint8_t* data, std::size_t size, bool check)
+    {
+        // An XorLinkedList iterator knows the node before its own, which adding to the start or end can
+        // change, so a new one is walked to the same position after them; the operations it doesn't
+        // have do nothing.
+        constexpr bool isDoublyLinkedList = std::is_same<List, DoublyLinkedList<int>>::value;
+
+        List list;
+        typename List::Iterator iterator = list.iterator();
+
+        std::list<int> reference;
+        long position = 0; // Of the iterator, in the reference; -1 is "past start".
+
+        for (std::size_t offset = 0; offset + operationBytes <= size; offset += operationBytes)
+        {
+            unsigned int operation = data[offset] % operationCount;
+            int value = data[offset + 1] | (data[offset + 2] << 8);
+            long referenceSize = static_cast<long>(reference.size());
+            bool resetIterator = false;
+            bool reseekIterator = false;
+
+            switch (operation)
+            {
+            case 0:
+                // An iterator past the start stays there; any other one moves along with its value.
+                list.addToStart(value);
+                if (check) { reference.push_front(value); }
+                if (position != -1) { position++; }
+                if (iterator.isPastStart() && iterator.isPastEnd()) { resetIterator = true; }
+                if (isDoublyLinkedList == false) { reseekIterator = true; }
+                break;
+
+            case 1:
+                // An iterator past the end stays there.
+                list.addToEnd(value);
+                if (check) { reference.push_back(value); }
+                if (position == referenceSize) { position++; }
+                if (iterator.isPastStart() && iterator.isPastEnd()) { resetIterator = true; }
+                if (isDoublyLinkedList == false) { reseekIterator = true; }
+                break;
+
+            case 2:
+            case 3:
+                if (list.isEmpty())
+                {
+                    if (operation == 2)
+                    {
+                        requireThrow<EmptyException>([&list]() { list.removeFromStart(); }, "removeFromStart() of an empty list didn't throw");
+                    }
+                    else
+                    {
+                        requireThrow<EmptyException>([&list]() { list.removeFromEnd(); }, "removeFromEnd() of an empty list didn't throw");
+                    }
+                }
+                else
+                {
+                    // The iterator may be referring to the removed value, so it starts again.
+                    if (operation == 2) { list.removeFromStart(); } else { list.removeFromEnd(); }
+                    if (check) { if (operation == 2) { reference.pop_front(); } else { reference.pop_back(); } }
+                    resetIterator = true;
+                }
+                break;
+
+            case 4:
+                if (iterator.isPastEnd())
+                {
+                    requireThrow<IteratorException>([&iterator]() { iterator.moveToNext(); }, "moveToNext() past end didn't throw");
+                }
+                else
+                {
+                    iterator.moveToNext();
+                    position++;
+                }
+                break;
+
+            case 5:
+                if (iterator.isPastStart())
+                {
+                    requireThrow<IteratorException>([&iterator]() { iterator.moveToPrevious(); }, "moveToPrevious() past start didn't throw");
+                }
+                else
+                {
+                    iterator.moveToPrevious();
+                    position--;
+                }
+                break;
+
+            case 6:
+                if (iterator.isPastStart())
+                {
+                    requireThrow<IteratorException>([&iterator, value]() { iterator.insertBefore(value); }, "insertBefore() past start didn't throw");
+                }
+                else
+                {
+                    iterator.insertBefore(value);
+                    if (check) { reference.insert(std::next(reference.begin(), position), value); }
+                    position++;
+                }
+                break;
+
+            case 7:
+                if (iterator.isPastEnd())
+                {
+                    requireThrow<IteratorException>([&iterator, value]() { iterator.insertAfter(value); }, "insertAfter() past end didn't throw");
+                }
+                else
+                {
+                    iterator.insertAfter(value);
+                    if (check) { reference.insert(std::next(reference.begin(), position + 1), value); }
+                }
+                break;
+
+            case 8:
+            case 9:
+                if (iterator.isPastStart() || iterator.isPastEnd())
+                {
+                    requireThrow<IteratorException>([&iterator]() { iterator.remove(); }, "remove() outside the list didn't throw");
+                }
+                else
+                {
+                    iterator.remove(operation == 8);
+                    if (check) { reference.erase(std::next(reference.begin(), position)); }
+                    if (operation == 9) { position--; }
+                    if (list.isEmpty()) { position = 0; }
+                }
+                break;
+
+            case 10:
+            {
+                List copy{list};
+                List other;
+                other.addToEnd(value);
+                other = copy;
+                list = other;
+                resetIterator = true;
+                break;
+            }
+
+            case 11:
+                if constexpr (isDoublyLinkedList)
+                {
+                    // Every other splice moves only the first few values, leaving the rest behind.
+                    int otherSize = value % 8;
+                    int moved = (value & 8) ? (value >> 4) % 10 : otherSize;
+                    moved = (moved < otherSize) ? moved : otherSize;
+
+                    DoublyLinkedList<int> other;
+                    for (int i = 0; i < otherSize; i++)
+                    {
+                        other.addToEnd(value + i);
+                        if (check && i < moved) { reference.push_back(value + i); }
+                    }
+
+                    if (value & 8) { list.spliceToEnd(other, static_cast<unsigned int>((value >> 4) % 10)); } else { list.spliceToEnd(other); }
+                    require(other.size() == static_cast<unsigned int>(otherSize - moved), "spliceToEnd() moved the wrong number of values");
+                    require(other.isEmpty() || other.first() == value + moved, "spliceToEnd() left the wrong values behind");
+                    resetIterator = true;
+                }
+                break;
+
+            case 12:
+                // Spare nodes kept by clearKeepingNodes() are reused by the adds that follow.
+                if (value % 8 == 0 || value % 8 == 1)
+                {
+                    if constexpr (isDoublyLinkedList)
+                    {
+                        if (value % 8 == 0) { list.clear(); } else { list.clearKeepingNodes(); }
+                    }
+                    else
+                    {
+                        list.clear();
+                    }
+                    if (check) { reference.clear(); }
+                    resetIterator = true;
+                }
+                else if (value % 8 == 2)
+                {
+                    if constexpr (isDoublyLinkedList)
+                    {
+                        list.releaseSpareNodes();
+                        require(list.spareNodeCount() == 0, "releaseSpareNodes() kept spare nodes");
+                    }
+                }
+                break;
+
+            case 13:
+                if constexpr (isDoublyLinkedList)
+                {
+                    list.relayout();
+                    resetIterator = true;
+                }
+                break;
+
+            case 14:
+            case 15:
+                if constexpr (isDoublyLinkedList)
+                {
+                    unsigned int count = static_cast<unsigned int>(value % 64);
+                    if (operation == 14) { list.rotateLeft(count); } else { list.rotateRight(count); }
+                    if (check && referenceSize > 0)
+                    {
+                        long shift = static_cast<long>(count % referenceSize);
+                        if (operation == 15) { shift = (referenceSize - shift) % referenceSize; }
+                        reference.splice(reference.end(), reference, reference.begin(), std::next(reference.begin(), shift));
+                    }
+                    resetIterator = true;
+                }
+                break;
+
+            case 16:
+                if constexpr (isDoublyLinkedList)
+                {
+                    list.reverse();
+                    if (check) { reference.reverse(); }
+                    resetIterator = true;
+                }
+                break;
+
+            case 17:
+            case 18:
+                if constexpr (isDoublyLinkedList)
+                {
+                    if (iterator.isPastStart() || iterator.isPastEnd())
+                    {
+                        requireThrow<IteratorException>([&list, &iterator]() { list.moveToFront(iterator); }, "moveToFront() outside the list didn't throw");
+                    }
+                    else
+                    {
+                        // The iterator keeps referring to the value it moved.
+                        if (operation == 17) { list.moveToFront(iterator); } else { list.moveToBack(iterator); }
+                        if (check)
+                        {
+                            std::list<int>::iterator moved = std::next(reference.begin(), position);
+                            reference.splice(operation == 17 ? reference.begin() : reference.end(), reference, moved);
+                        }
+                        position = (operation == 17) ? 0 : referenceSize - 1;
+                    }
+                }
+                break;
+            }
+
+            if (resetIterator)
+            {
+                iterator = list.iterator();
+                position = 0;
+            }
+            else if (reseekIterator)
+            {
+                iterator = list.iterator();
+
+                if (position == -1)
+                {
+                    iterator.moveToPrevious();
+                }
+
+                for (long i = 0; i < position; i++)
+                {
+                    iterator.moveToNext();
+                }
+            }
+
+            if (check)
+            {
+                checkContents(list, reference);
+                checkIterator<List>(iterator, reference, position);
+            }
+        }
+    }
+
+
+    std::vector<std::uint8_t> randomOperations(std::mt19937& random, std::size_t count)
+    {
+        std::vector<std::uint8_t> data(count * operationBytes);
+
+        for (std::uint8_t& byte : data)
+        {
+            byte = static_cast<std::uint8_t>(random());
+        }
+
+        return data;
+    }
+
+
+    bool readFile(const char* path, std::vector<std::uint8_t>& data)
+    {
+        std::ifstream file{path, std::ios::binary};
+        data.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        return file.good() || file.eof();
+    }
+
+
+    // Writes a trace of random operations, favouring the end operations
+    // that real workloads are mostly made of.
+    int record(const char* path, std::size_t count)
+    {
+        std::mt19937 random{12345};
+        std::vector<std::uint8_t> data = randomOperations(random, count);
+
+        for (std::size_t offset = 0; offset < data.size(); offset += operationBytes)
+        {
+            // Full-list operations (copies, relayout, rotation, reversal) are kept rare so that
+            // the trace doesn't spend all its time in them.
+            unsigned int operation = data[offset] % operationCount;
+            if (operation >= 10 && random() % 1000 != 0)
+            {
+                data[offset] = static_cast<std::uint8_t>(random() % 10);
+            }
+        }
+
+        std::ofstream file{path, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        return file.good() ? 0 : 1;
+    }
+
+
+    int replay(const char* tracePath, const char* baselinePath, double allowedRegression)
+    {
+        std::vector<std::uint8_t> data;
+
+        if (readFile(tracePath, data) == false || data.empty())
+        {
+            std::fprintf(stderr, "can't read trace %s\n", tracePath);
+            return 1;
+        }
+
+        double operations = static_cast<double>(data.size() / operationBytes);
+        double best = 0.0;
+
+        for (int run = 0; run < 7; run++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            runOperations<DoublyLinkedList<int>>(data.data(), data.size(), false);
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (operations / elapsed.count() > best)
+            {
+                best = operations / elapsed.count();
+            }
+        }
+
+        std::printf("%.0f operations per second\n", best);
+
+        std::ifstream baselineFile{baselinePath};
+        double baseline;
+
+        if (static_cast<bool>(baselineFile >> baseline) == false)
+        {
+            std::ofstream{baselinePath} << best << '\n';
+            std::printf("wrote baseline to %s\n", baselinePath);
+            return 0;
+        }
+
+        if (best < baseline * (1.0 - allowedRegression))
+        {
+            std::printf("REGRESSION: %.1f%% below the baseline of %.0f\n", 100.0 * (1.0 - best / baseline), baseline);
+            return 1;
+        }
+
+        std::printf("within %.0f%% of the baseline of %.0f\n", 100.0 * allowedRegression, baseline);
+        return 0;
+    }
+}
+
+
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    runOperations<DoublyLinkedList<int>>(data, size, true);
+    runOperations<XorLinkedList<int>>(data, size, true);
+    return 0;
+}
+
+
+
+#if !defined(DOUBLYLINKEDLIST_LIBFUZZER)
+int main(int argc, char** argv)
+{
+    std::vector<std::string> arguments{argv + 1, argv + argc};
+
+    if (arguments.size() >= 2 && arguments[0] == "--record")
+    {
+        return record(arguments[1].c_str(), arguments.size() >= 3 ? std::stoul(arguments[2]) : 10000000);
+    }
+    else if (arguments.size() >= 3 && arguments[0] == "--replay")
+    {
+        return replay(arguments[1].c_str(), arguments[2].c_str(), arguments.size() >= 4 ? std::stod(arguments[3]) : 0.15);
+    }
+    else if (arguments.empty() || arguments[0] == "--random")
+    {
+        unsigned long inputs = arguments.size() >= 2 ? std::stoul(arguments[1]) : 10000;
+        std::mt19937 random{1};
+
+        for (unsigned long input = 0; input < inputs; input++)
+        {
+            std::vector<std::uint8_t> data = randomOperations(random, 1 + random() % 200);
+            LLVMFuzzerTestOneInput(data.data(), data.size());
+        }
+
+        std::printf("%lu random inputs passed\n", inputs);
+        return 0;
+    }
+
+    for (const std::string& path : arguments)
+    {
+        std::vector<std::uint8_t> data;
+
+        if (readFile(path.c_str(), data) == false)
+        {
+            std::fprintf(stderr, "can't read %s\n", path.c_str());
+            return 1;
+        }
+
+        LLVMFuzzerTestOneInput(data.data(), data.size());
+    }
+
+    std::printf("%zu inputs passed\n", arguments.size());
+    return 0;
+}
+#endif
@@ -0,0 +1,296 @@
+// DoublyLinkedListTrace.hpp
+// Optional tracing of DoublyLinkedList operations.
+//
+// When DOUBLYLINKEDLIST_ENABLE_TRACING is defined before this header (or
+// DoublyLinkedList.hpp) is included, the operations that add, remove or
+// copy values each record a span: the operation's name, when it started
+// and how long it took.  Spans are written to a fixed-size ring buffer
+// that belongs to the calling thread, so recording one takes no locks
+// and the buffer never grows; once it is full, the oldest spans are
+// overwritten.  writeChromeTrace() then writes every thread's spans as
+// Chrome trace event JSON, which chrome://tracing and the Perfetto UI
+// (ui.perfetto.dev) can both open.
+//
+//     #define DOUBLYLINKEDLIST_ENABLE_TRACING
+//     #include "DoublyLinkedList.hpp"
+//
+//     ... run the workload ...
+//
+//     std::ofstream out{"list-trace.json"};
+//     writeChromeTrace(out);
+//
+// When DOUBLYLINKEDLIST_ENABLE_TRACING isn't defined, DOUBLYLINKEDLIST_TRACE
+// expands to nothing, so the trace points cost nothing at all.
+//
+// writeChromeTrace() and clearTrace() can be called while other threads
+// are still recording, without stopping them.  Each slot of a ring has a
+// sequence number that its owner makes odd while writing the slot and
+// even again once done (a seqlock), and which also says which span the
+// slot holds, so a reader skips any span that was overwritten while it
+// was being read rather than writing it out garbled.  Clearing doesn't
+// touch what the owner writes: it moves the point that readers start
+// from up to the newest span.
+
+
+#ifndef DOUBLYLINKEDLISTTRACE_HPP
+#define DOUBLYLINKEDLISTTRACE_HPP
+
+
+#if defined(DOUBLYLINKEDLIST_ENABLE_TRACING)
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+
+
+// A per-thread ring buffer of spans, written only by the thread that owns
+// it, and read (or cleared) by any thread.
+class TraceRing
+{
+public:
+    // The number of spans each thread keeps.
+    static constexpr std::size_t capacity = 1 << 16;
+
+    struct Span
+    {
+        const char* name;
+        std::uint64_t startNanoseconds;
+        std::uint64_t durationNanoseconds;
+    };
+
+
+    explicit TraceRing(unsigned int threadNumber)
+        : threadNumber{threadNumber}, written{0}, cleared{0}, slots{new Slot[capacity]}
+    {
+    }
+
+
+    // record() stores a span, overwriting the oldest one if the ring is
+    // full.  Only the thread that owns the ring may call it.
+    void record(const char* name, std::uint64_t startNanoseconds, std::uint64_t durationNanoseconds) noexcept
+    {
+        std::uint64_t index = written.load(std::memory_order_relaxed);
+        Slot& slot = slots[index % capacity];
+
+        // Each field is stored with release, so a reader that sees any of them also sees the slot marked
+        // as being written.  (A release fence would do the same, but ThreadSanitizer doesn't model fences.)
+        slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+
+        slot.name.store(name, std::memory_order_release);
+        slot.startNanoseconds.store(startNanoseconds, std::memory_order_release);
+        slot.durationNanoseconds.store(durationNanoseconds, std::memory_order_release);
+
+        slot.sequence.store(2 * index + 2, std::memory_order_release);
+        written.store(index + 1, std::memory_order_release);
+    }
+
+
+    // forEachSpan() calls the function with every span still in the ring,
+    // oldest first, skipping any that are overwritten while being read.
+    template <typename Function>
+    void forEachSpan(Function function) const
+    {
+        std::uint64_t end = written.load(std::memory_order_acquire);
+        std::uint64_t begin = (end > capacity) ? end - capacity : 0;
+        std::uint64_t clearedEnd = cleared.load(std::memory_order_acquire);
+
+        for (std::uint64_t index = (begin > clearedEnd ? begin : clearedEnd); index < end; index++)
+        {
+            const Slot& slot = slots[index % capacity];
+            std::uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+            // Loading each field with acquire keeps the second look at the sequence after all of them.
+            Span span{slot.name.load(std::memory_order_acquire), slot.startNanoseconds.load(std::memory_order_acquire),
+                      slot.durationNanoseconds.load(std::memory_order_acquire)};
+
+            if (sequence == 2 * index + 2 && slot.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                function(span);
+            }
+        }
+    }
+
+
+    // clear() forgets every span in the ring so far.  Any thread may call
+    // it; spans recorded while it runs may or may not be forgotten.
+    void clear() noexcept
+    {
+        std::uint64_t end = written.load(std::memory_order_acquire);
+        std::uint64_t clearedEnd = cleared.load(std::memory_order_relaxed);
+
+        // Two threads clearing at once mustn't move the start back.
+        while (clearedEnd < end && cleared.compare_exchange_weak(clearedEnd, end, std::memory_order_release) == false)
+        {
+        }
+    }
+
+
+    unsigned int thread() const noexcept
+    {
+        return threadNumber;
+    }
+
+
+private:
+    // A span as it sits in the ring.  sequence is 2 * index + 1 while the
+    // span with that index is being written, and 2 * index + 2 once it has
+    // been.
+    struct Slot
+    {
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::uint64_t> startNanoseconds{0};
+        std::atomic<std::uint64_t> durationNanoseconds{0};
+    };
+
+
+    unsigned int threadNumber;
+
+    // The number of spans ever recorded, and the number of those that have
+    // been cleared.
+    std::atomic<std::uint64_t> written;
+    std::atomic<std::uint64_t> cleared;
+
+    std::unique_ptr<Slot[]> slots;
+};
+
+
+
+// Every thread's ring, kept alive after the thread exits so that its
+// spans can still be written out.
+class TraceRegistry
+{
+public:
+    static TraceRegistry& instance()
+    {
+        static TraceRegistry* registry = new TraceRegistry;
+        return *registry;
+    }
+
+
+    // ringForThisThread() returns the calling thread's ring, creating and
+    // registering it the first time a thread asks.
+    TraceRing& ringForThisThread()
+    {
+        thread_local std::shared_ptr<TraceRing> ring = registerRing();
+        return *ring;
+    }
+
+
+    template <typename Function>
+    void forEachRing(Function function)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        for (const std::shared_ptr<TraceRing>& ring : rings)
+        {
+            function(*ring);
+        }
+    }
+
+
+private:
+    std::shared_ptr<TraceRing> registerRing()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+
+        rings.push_back(std::make_shared<TraceRing>(static_cast<unsigned int>(rings.size()) + 1));
+        return rings.back();
+    }
+
+
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceRing>> rings;
+};
+
+
+
+// Nanoseconds on a clock that never goes backward, shared by every thread.
+inline std::uint64_t traceNow() noexcept
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+
+// Records a span covering its own lifetime, so that it times a whole
+// operation however that operation ends (including by an exception).
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name) noexcept
+        : name{name}, startNanoseconds{traceNow()}
+    {
+    }
+
+    ~TraceSpan() noexcept
+    {
+        std::uint64_t endNanoseconds = traceNow();
+        TraceRegistry::instance().ringForThisThread().record(name, startNanoseconds, endNanoseconds - startNanoseconds);
+    }
+
+    TraceSpan(const TraceSpan& span) = delete;
+    TraceSpan& operator=(const TraceSpan& span) = delete;
+
+private:
+    const char* name;
+    std::uint64_t startNanoseconds;
+};
+
+
+
+// writeChromeTrace() writes every thread's spans to the stream as Chrome
+// trace event JSON ("complete" events, with times in microseconds).
+inline void writeChromeTrace(std::ostream& out)
+{
+    bool firstEvent = true;
+
+    out << "{\"traceEvents\":[";
+
+    TraceRegistry::instance().forEachRing(
+        [&out, &firstEvent](const TraceRing& ring)
+        {
+            ring.forEachSpan(
+                [&out, &firstEvent, &ring](const TraceRing::Span& span)
+                {
+                    out << (firstEvent ? "\n" : ",\n");
+                    out << "{\"name\":\"" << span.name << "\",\"cat\":\"DoublyLinkedList\",\"ph\":\"X\""
+                        << ",\"ts\":" << span.startNanoseconds / 1000 << "." << (span.startNanoseconds % 1000) / 100
+                        << ",\"dur\":" << span.durationNanoseconds / 1000 << "." << (span.durationNanoseconds % 1000) / 100
+                        << ",\"pid\":1,\"tid\":" << ring.thread() << "}";
+
+                    firstEvent = false;
+                });
+        });
+
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+
+// clearTrace() forgets every span recorded so far, on every thread.
+inline void clearTrace()
+{
+    TraceRegistry::instance().forEachRing([](TraceRing& ring) { ring.clear(); });
+}
+
+
+#define DOUBLYLINKEDLIST_TRACE_CONCATENATE_(a, b) a##b
+#define DOUBLYLINKEDLIST_TRACE_CONCATENATE(a, b) DOUBLYLINKEDLIST_TRACE_CONCATENATE_(a, b)
+#define DOUBLYLINKEDLIST_TRACE(name) TraceSpan DOUBLYLINKEDLIST_TRACE_CONCATENATE(traceSpan, __LINE__){name}
+
+#else
+
+#define DOUBLYLINKEDLIST_TRACE(name)
+
+#endif
+
+
+
+#endif
+
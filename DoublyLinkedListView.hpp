@@ -0,0 +1,755 @@
+// DoublyLinkedListView.hpp
+// Lazy views over a DoublyLinkedList.
+//
+// A view describes a pipeline of steps (filter, transform, take, drop,
+// reverse) over a list without doing any of the work.  Nothing is
+// evaluated, and no intermediate list is built, until the view is
+// consumed by forEach(), count(), collect() or collectInto(), and each
+// of those walks the underlying list exactly once, passing each value
+// through every step in turn.
+//
+//     auto firstTenSquares = view(list)
+//                                .filter([](int v) { return v % 2 == 0; })
+//                                .transform([](int v) { return v * v; })
+//                                .take(10)
+//                                .collect();
+//
+// A view refers to its list rather than copying it, so the list must
+// outlive the view.  Since a view starts from the list's first (or last)
+// value when it is consumed, the list may be changed between building a
+// view and consuming it, but not while the view is being consumed.
+//
+// Every step is a "cursor" that supports start(), isPastEnd(), value()
+// and moveToNext(), following the same conventions as ConstIterator, and
+// knownSize(), which reports how many values it will produce when that
+// is known without evaluating anything.  reverse() is only available
+// when every step below it can be reversed, which is true of lists,
+// filters and transforms, but not of take() and drop(), whose meaning
+// depends on direction.
+
+
+#ifndef DOUBLYLINKEDLISTVIEW_HPP
+#define DOUBLYLINKEDLISTVIEW_HPP
+
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "DoublyLinkedList.hpp"
+
+
+
+// A cursor that walks a DoublyLinkedList, forward or backward.
+template <typename ElementType, typename NodeStorage = HeapNodeStorage>
+class ListCursor
+{
+public:
+    using ValueType = ElementType;
+
+    // Initializes a cursor over the given list, walking it from last to
+    // first if backward is true.
+    ListCursor(const DoublyLinkedList<ElementType, NodeStorage>& list, bool backward) noexcept;
+
+    // start() positions the cursor at the list's first value (or last
+    // value when walking backward).
+    void start() noexcept;
+
+    bool isPastEnd() const noexcept;
+    const ElementType& value() const;
+    void moveToNext();
+
+    // knownSize() stores the number of values the cursor will produce into
+    // size and returns true, if that is known without evaluating any of
+    // them, and returns false otherwise.
+    bool knownSize(unsigned int& size) const noexcept;
+
+    // reversed() returns a cursor over the same list in the other direction.
+    ListCursor reversed() const noexcept;
+
+private:
+    const DoublyLinkedList<ElementType, NodeStorage>* list;
+    typename DoublyLinkedList<ElementType, NodeStorage>::ConstIterator iterator;
+    bool backward;
+};
+
+
+// A cursor that only stops at the values of its source for which the
+// predicate returns true.  When the source computes its values (such as
+// a TransformCursor), each accepted value is kept, so that the source
+// computes it only once.
+template <typename Source, typename Predicate>
+class FilterCursor
+{
+public:
+    using ValueType = typename Source::ValueType;
+
+    FilterCursor(const Source& source, const Predicate& predicate);
+
+    void start();
+    bool isPastEnd() const noexcept;
+    decltype(auto) value() const;
+    void moveToNext();
+    bool knownSize(unsigned int& size) const noexcept;
+    FilterCursor<decltype(std::declval<const Source&>().reversed()), Predicate> reversed() const;
+
+private:
+    using SourceValue = decltype(std::declval<const Source&>().value());
+
+    // Whether the source returns its values by value, rather than a
+    // reference to a value that stays put.
+    static constexpr bool keepsValue = std::is_reference<SourceValue>::value == false;
+
+    // Moves the source forward until it refers to a matching value.
+    void skipRejected();
+
+    Source source;
+    Predicate predicate;
+    std::optional<std::conditional_t<keepsValue, ValueType, bool>> acceptedValue;
+};
+
+
+// A cursor whose values are the results of calling the function on each
+// value of its source.  The function is called once per value() call.
+template <typename Source, typename Function>
+class TransformCursor
+{
+public:
+    using ValueType = std::decay_t<std::invoke_result_t<const Function&, decltype(std::declval<const Source&>().value())>>;
+
+    TransformCursor(const Source& source, const Function& function);
+
+    void start();
+    bool isPastEnd() const noexcept;
+    ValueType value() const;
+    void moveToNext();
+    bool knownSize(unsigned int& size) const noexcept;
+    TransformCursor<decltype(std::declval<const Source&>().reversed()), Function> reversed() const;
+
+private:
+    Source source;
+    Function function;
+};
+
+
+// A cursor that stops after the first count values of its source.
+template <typename Source>
+class TakeCursor
+{
+public:
+    using ValueType = typename Source::ValueType;
+
+    TakeCursor(const Source& source, unsigned int count);
+
+    void start();
+    bool isPastEnd() const noexcept;
+    decltype(auto) value() const;
+    void moveToNext();
+    bool knownSize(unsigned int& size) const noexcept;
+
+private:
+    Source source;
+    unsigned int count;
+    unsigned int remaining;
+};
+
+
+// A cursor that skips the first count values of its source.
+template <typename Source>
+class DropCursor
+{
+public:
+    using ValueType = typename Source::ValueType;
+
+    DropCursor(const Source& source, unsigned int count);
+
+    void start();
+    bool isPastEnd() const noexcept;
+    decltype(auto) value() const;
+    void moveToNext();
+    bool knownSize(unsigned int& size) const noexcept;
+
+private:
+    Source source;
+    unsigned int count;
+};
+
+
+template <typename Cursor>
+class ListView
+{
+public:
+    // The type of the values this view produces.
+    using ValueType = typename Cursor::ValueType;
+
+
+    // Initializes a view whose values are those of the given cursor.
+    explicit ListView(const Cursor& cursor);
+
+
+    // filter() returns a view of only those values for which the
+    // predicate returns true.
+    template <typename Predicate>
+    ListView<FilterCursor<Cursor, Predicate>> filter(Predicate predicate) const;
+
+    // transform() returns a view of the results of calling the function
+    // on each value.
+    template <typename Function>
+    ListView<TransformCursor<Cursor, Function>> transform(Function function) const;
+
+    // take() returns a view of at most the first count values.
+    ListView<TakeCursor<Cursor>> take(unsigned int count) const;
+
+    // drop() returns a view of all but the first count values.
+    ListView<DropCursor<Cursor>> drop(unsigned int count) const;
+
+    // reverse() returns a view of the same values in the opposite order.
+    // It does not compile if the view contains a take() or drop() step.
+    auto reverse() const;
+
+
+    // forEach() evaluates the view, calling the function once with each
+    // of its values, in order.
+    template <typename Function>
+    void forEach(Function function) const;
+
+    // count() returns the number of values in the view.  The view is only
+    // evaluated when it has a filter() step, since otherwise the number is
+    // known from the size of the list.
+    unsigned int count() const;
+
+    // collect() evaluates the view into a new DoublyLinkedList.
+    DoublyLinkedList<ValueType> collect() const;
+
+    // collectInto() evaluates the view, adding its values to the end of
+    // the given container, which may be a DoublyLinkedList or any
+    // container with push_back().  When the container has reserve() and
+    // the number of values is known without evaluating them (when the view
+    // has no filter() step), the container is sized only once.
+    template <typename Container>
+    void collectInto(Container& container) const;
+
+
+private:
+    Cursor cursor;
+};
+
+
+// view() returns a view of the values of the given list, first to last.
+template <typename ElementType, typename NodeStorage>
+ListView<ListCursor<ElementType, NodeStorage>> view(const DoublyLinkedList<ElementType, NodeStorage>& list);
+
+// reverseView() returns a view of the values of the given list, last to
+// first.
+template <typename ElementType, typename NodeStorage>
+ListView<ListCursor<ElementType, NodeStorage>> reverseView(const DoublyLinkedList<ElementType, NodeStorage>& list);
+
+
+
+//
+// ListCursor member functions //
+//
+
+
+template <typename ElementType, typename NodeStorage>
+ListCursor<ElementType, NodeStorage>::ListCursor(const DoublyLinkedList<ElementType, NodeStorage>& list, bool backward) noexcept
+    : list{&list}, iterator{list.constIterator()}, backward{backward}
+{
+}
+
+
+// Picks up the list's current head or tail.
+template <typename ElementType, typename NodeStorage>
+void ListCursor<ElementType, NodeStorage>::start() noexcept
+{
+    iterator = backward ? list->constIteratorAtEnd() : list->constIterator();
+}
+
+
+// When walking backward, running off the start is the end of the walk.
+template <typename ElementType, typename NodeStorage>
+bool ListCursor<ElementType, NodeStorage>::isPastEnd() const noexcept
+{
+    return backward ? iterator.isPastStart() : iterator.isPastEnd();
+}
+
+
+template <typename ElementType, typename NodeStorage>
+const ElementType& ListCursor<ElementType, NodeStorage>::value() const
+{
+    return iterator.value();
+}
+
+
+template <typename ElementType, typename NodeStorage>
+void ListCursor<ElementType, NodeStorage>::moveToNext()
+{
+    if (backward)
+    {
+        iterator.moveToPrevious();
+    }
+    else
+    {
+        iterator.moveToNext();
+    }
+}
+
+
+template <typename ElementType, typename NodeStorage>
+bool ListCursor<ElementType, NodeStorage>::knownSize(unsigned int& size) const noexcept
+{
+    size = list->size();
+    return true;
+}
+
+
+template <typename ElementType, typename NodeStorage>
+ListCursor<ElementType, NodeStorage> ListCursor<ElementType, NodeStorage>::reversed() const noexcept
+{
+    return ListCursor{*list, !backward};
+}
+
+
+
+//
+// FilterCursor member functions //
+//
+
+
+template <typename Source, typename Predicate>
+FilterCursor<Source, Predicate>::FilterCursor(const Source& source, const Predicate& predicate)
+    : source{source}, predicate{predicate}, acceptedValue{}
+{
+}
+
+
+template <typename Source, typename Predicate>
+void FilterCursor<Source, Predicate>::start()
+{
+    source.start();
+    skipRejected();
+}
+
+
+template <typename Source, typename Predicate>
+bool FilterCursor<Source, Predicate>::isPastEnd() const noexcept
+{
+    return source.isPastEnd();
+}
+
+
+template <typename Source, typename Predicate>
+decltype(auto) FilterCursor<Source, Predicate>::value() const
+{
+    if constexpr (keepsValue)
+    {
+        return static_cast<const ValueType&>(*acceptedValue);
+    }
+    else
+    {
+        return source.value();
+    }
+}
+
+
+template <typename Source, typename Predicate>
+void FilterCursor<Source, Predicate>::moveToNext()
+{
+    source.moveToNext();
+    skipRejected();
+}
+
+
+// How many values pass the predicate can't be known without trying them.
+template <typename Source, typename Predicate>
+bool FilterCursor<Source, Predicate>::knownSize(unsigned int&) const noexcept
+{
+    return false;
+}
+
+
+template <typename Source, typename Predicate>
+FilterCursor<decltype(std::declval<const Source&>().reversed()), Predicate> FilterCursor<Source, Predicate>::reversed() const
+{
+    return {source.reversed(), predicate};
+}
+
+
+// Stops at the next value the predicate accepts, or past the end.  A computed value is
+// kept from the time it is tested, so that value() doesn't compute it again.
+template <typename Source, typename Predicate>
+void FilterCursor<Source, Predicate>::skipRejected()
+{
+    if constexpr (keepsValue)
+    {
+        acceptedValue.reset();
+
+        for (; source.isPastEnd() == false; source.moveToNext())
+        {
+            acceptedValue.emplace(source.value());
+
+            if (predicate(static_cast<const ValueType&>(*acceptedValue)) == true)
+            {
+                return;
+            }
+        }
+
+        acceptedValue.reset();
+    }
+    else
+    {
+        while (source.isPastEnd() == false && predicate(source.value()) == false)
+        {
+            source.moveToNext();
+        }
+    }
+}
+
+
+
+//
+// TransformCursor member functions //
+//
+
+
+template <typename Source, typename Function>
+TransformCursor<Source, Function>::TransformCursor(const Source& source, const Function& function)
+    : source{source}, function{function}
+{
+}
+
+
+template <typename Source, typename Function>
+void TransformCursor<Source, Function>::start()
+{
+    source.start();
+}
+
+
+template <typename Source, typename Function>
+bool TransformCursor<Source, Function>::isPastEnd() const noexcept
+{
+    return source.isPastEnd();
+}
+
+
+template <typename Source, typename Function>
+typename TransformCursor<Source, Function>::ValueType TransformCursor<Source, Function>::value() const
+{
+    return function(source.value());
+}
+
+
+template <typename Source, typename Function>
+void TransformCursor<Source, Function>::moveToNext()
+{
+    source.moveToNext();
+}
+
+
+template <typename Source, typename Function>
+bool TransformCursor<Source, Function>::knownSize(unsigned int& size) const noexcept
+{
+    return source.knownSize(size);
+}
+
+
+template <typename Source, typename Function>
+TransformCursor<decltype(std::declval<const Source&>().reversed()), Function> TransformCursor<Source, Function>::reversed() const
+{
+    return {source.reversed(), function};
+}
+
+
+
+//
+// TakeCursor member functions //
+//
+
+
+template <typename Source>
+TakeCursor<Source>::TakeCursor(const Source& source, unsigned int count)
+    : source{source}, count{count}, remaining{count}
+{
+}
+
+
+template <typename Source>
+void TakeCursor<Source>::start()
+{
+    source.start();
+    remaining = count;
+}
+
+
+template <typename Source>
+bool TakeCursor<Source>::isPastEnd() const noexcept
+{
+    return remaining == 0 || source.isPastEnd();
+}
+
+
+template <typename Source>
+decltype(auto) TakeCursor<Source>::value() const
+{
+    return source.value();
+}
+
+
+// Stops walking the source as soon as the last value has been taken.
+template <typename Source>
+void TakeCursor<Source>::moveToNext()
+{
+    remaining--;
+
+    if (remaining > 0)
+    {
+        source.moveToNext();
+    }
+}
+
+
+template <typename Source>
+bool TakeCursor<Source>::knownSize(unsigned int& size) const noexcept
+{
+    if (source.knownSize(size) == false)
+    {
+        return false;
+    }
+
+    if (size > count)
+    {
+        size = count;
+    }
+
+    return true;
+}
+
+
+
+//
+// DropCursor member functions //
+//
+
+
+template <typename Source>
+DropCursor<Source>::DropCursor(const Source& source, unsigned int count)
+    : source{source}, count{count}
+{
+}
+
+
+// Skips the dropped values only when evaluation actually starts.
+template <typename Source>
+void DropCursor<Source>::start()
+{
+    source.start();
+
+    for (unsigned int i = 0; i < count && source.isPastEnd() == false; i++)
+    {
+        source.moveToNext();
+    }
+}
+
+
+template <typename Source>
+bool DropCursor<Source>::isPastEnd() const noexcept
+{
+    return source.isPastEnd();
+}
+
+
+template <typename Source>
+decltype(auto) DropCursor<Source>::value() const
+{
+    return source.value();
+}
+
+
+template <typename Source>
+void DropCursor<Source>::moveToNext()
+{
+    source.moveToNext();
+}
+
+
+template <typename Source>
+bool DropCursor<Source>::knownSize(unsigned int& size) const noexcept
+{
+    if (source.knownSize(size) == false)
+    {
+        return false;
+    }
+
+    size = (size > count) ? size - count : 0;
+    return true;
+}
+
+
+
+//
+// ListView member functions //
+//
+
+
+template <typename Cursor>
+ListView<Cursor>::ListView(const Cursor& cursor)
+    : cursor{cursor}
+{
+}
+
+
+template <typename Cursor>
+template <typename Predicate>
+ListView<FilterCursor<Cursor, Predicate>> ListView<Cursor>::filter(Predicate predicate) const
+{
+    return ListView<FilterCursor<Cursor, Predicate>>{FilterCursor<Cursor, Predicate>{cursor, predicate}};
+}
+
+
+template <typename Cursor>
+template <typename Function>
+ListView<TransformCursor<Cursor, Function>> ListView<Cursor>::transform(Function function) const
+{
+    return ListView<TransformCursor<Cursor, Function>>{TransformCursor<Cursor, Function>{cursor, function}};
+}
+
+
+template <typename Cursor>
+ListView<TakeCursor<Cursor>> ListView<Cursor>::take(unsigned int count) const
+{
+    return ListView<TakeCursor<Cursor>>{TakeCursor<Cursor>{cursor, count}};
+}
+
+
+template <typename Cursor>
+ListView<DropCursor<Cursor>> ListView<Cursor>::drop(unsigned int count) const
+{
+    return ListView<DropCursor<Cursor>>{DropCursor<Cursor>{cursor, count}};
+}
+
+
+// Each step passes the reversal down to the step below it, until it reaches the list.
+template <typename Cursor>
+auto ListView<Cursor>::reverse() const
+{
+    return ListView<decltype(cursor.reversed())>{cursor.reversed()};
+}
+
+
+// Walks a fresh copy of the cursor so that the view can be evaluated again later.
+template <typename Cursor>
+template <typename Function>
+void ListView<Cursor>::forEach(Function function) const
+{
+    Cursor walker{cursor};
+
+    for (walker.start(); walker.isPastEnd() == false; walker.moveToNext())
+    {
+        function(walker.value());
+    }
+}
+
+
+template <typename Cursor>
+unsigned int ListView<Cursor>::count() const
+{
+    unsigned int total = 0;
+
+    if (cursor.knownSize(total) == true)
+    {
+        return total;
+    }
+
+    Cursor walker{cursor};
+
+    for (walker.start(); walker.isPastEnd() == false; walker.moveToNext())
+    {
+        total++;
+    }
+
+    return total;
+}
+
+
+template <typename Cursor>
+DoublyLinkedList<typename ListView<Cursor>::ValueType> ListView<Cursor>::collect() const
+{
+    DoublyLinkedList<ValueType> list;
+    collectInto(list);
+    return list;
+}
+
+
+namespace DoublyLinkedListViewDetails
+{
+    // Whether a container has reserve(), which collectInto() uses to size it up front.
+    template <typename Container, typename = void>
+    struct HasReserve : std::false_type
+    {
+    };
+
+    template <typename Container>
+    struct HasReserve<Container, std::void_t<decltype(std::declval<Container&>().reserve(0u))>> : std::true_type
+    {
+    };
+
+
+    // Whether a container adds to its end with push_back() rather than addToEnd().
+    template <typename Container, typename Value, typename = void>
+    struct HasPushBack : std::false_type
+    {
+    };
+
+    template <typename Container, typename Value>
+    struct HasPushBack<Container, Value, std::void_t<decltype(std::declval<Container&>().push_back(std::declval<Value>()))>> : std::true_type
+    {
+    };
+}
+
+
+template <typename Cursor>
+template <typename Container>
+void ListView<Cursor>::collectInto(Container& container) const
+{
+    if constexpr (DoublyLinkedListViewDetails::HasReserve<Container>::value)
+    {
+        unsigned int size;
+
+        if (cursor.knownSize(size) == true)
+        {
+            container.reserve(container.size() + size);
+        }
+    }
+
+    forEach(
+        [&container](auto&& value)
+        {
+            if constexpr (DoublyLinkedListViewDetails::HasPushBack<Container, decltype(value)>::value)
+            {
+                container.push_back(std::forward<decltype(value)>(value));
+            }
+            else
+            {
+                container.addToEnd(value);
+            }
+        });
+}
+
+
+
+template <typename ElementType, typename NodeStorage>
+ListView<ListCursor<ElementType, NodeStorage>> view(const DoublyLinkedList<ElementType, NodeStorage>& list)
+{
+    return ListView<ListCursor<ElementType, NodeStorage>>{ListCursor<ElementType, NodeStorage>{list, false}};
+}
+
+
+template <typename ElementType, typename NodeStorage>
+ListView<ListCursor<ElementType, NodeStorage>> reverseView(const DoublyLinkedList<ElementType, NodeStorage>& list)
+{
+    return ListView<ListCursor<ElementType, NodeStorage>>{ListCursor<ElementType, NodeStorage>{list, true}};
+}
+
+
+
+#endif
+
@@ -0,0 +1,102 @@
+// EqualityBenchmark.cpp
+// Measures operator== on large lists that are identical or differ only in
+// their last value or their length, against walking two ConstIterators by
+// hand, and hash() from scratch against hash() kept up to date as a
+// sliding window moves.
+//
+//     g++ -std=c++17 -O2 EqualityBenchmark.cpp -o EqualityBenchmark
+//     ./EqualityBenchmark [values, default 10000000]
+
+
+#include <chrono>
+#include <cstdio>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    // How equality was checked before the list had operator==.
+    bool equalByHand(const DoublyLinkedList<long>& first, const DoublyLinkedList<long>& second)
+    {
+        DoublyLinkedList<long>::ConstIterator firstIterator = first.constIterator();
+        DoublyLinkedList<long>::ConstIterator secondIterator = second.constIterator();
+
+        while (firstIterator.isPastEnd() == false && secondIterator.isPastEnd() == false)
+        {
+            if (firstIterator.value() != secondIterator.value())
+            {
+                return false;
+            }
+
+            firstIterator.moveToNext();
+            secondIterator.moveToNext();
+        }
+
+        return firstIterator.isPastEnd() == secondIterator.isPastEnd();
+    }
+
+
+    void compare(const char* name, const DoublyLinkedList<long>& first, const DoublyLinkedList<long>& second)
+    {
+        bool byHand;
+        bool byOperator;
+
+        double handSeconds = bestOf(3, [&first, &second, &byHand] { byHand = equalByHand(first, second); });
+        double operatorSeconds = bestOf(3, [&first, &second, &byOperator] { byOperator = first == second; });
+
+        std::printf("%-22s by hand %9.3f ms   operator== %9.3f ms%s\n", name, handSeconds * 1e3, operatorSeconds * 1e3,
+            byHand == byOperator ? "" : "  (results differ!)");
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 10000000);
+
+    DoublyLinkedList<long> original;
+    for (unsigned long i = 0; i < values; i++)
+    {
+        original.addToEnd(static_cast<long>(i));
+    }
+
+    DoublyLinkedList<long> same{original};
+    DoublyLinkedList<long> lastDiffers{original};
+    lastDiffers.last() = -1;
+    DoublyLinkedList<long> longer{original};
+    longer.addToEnd(0);
+
+    std::printf("%lu values\n", values);
+    compare("identical", original, same);
+    compare("last value differs", original, lastDiffers);
+    compare("one value longer", original, longer);
+
+    // A window that slides by one value per step, hashed after every step.
+    constexpr int steps = 1000;
+
+    DoublyLinkedList<long> window{original};
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::size_t hash = window.hash();
+    double firstHash = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+    {
+        window.removeFromStart();
+        window.addToEnd(static_cast<long>(values) + step);
+        hash = window.hash();
+    }
+    double perStep = secondsSince(start) / steps;
+
+    // A list built value by value has no cached hash, so this one is computed from scratch.
+    DoublyLinkedList<long> rebuilt;
+    window.forEach([&rebuilt](long value) { rebuilt.addToEnd(value); });
+
+    std::printf("hash() from scratch %9.3f ms   after each slide of the window %7.1f ns%s\n", firstHash * 1e3, perStep * 1e9,
+        hash == rebuilt.hash() ? "" : "  (hashes differ!)");
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+// HugePageBenchmark.cpp
+// Measures filling, scanning and clearing a large list with its nodes on
+// the heap and with them in huge pages, from one thread or several.
+//
+//     g++ -std=c++17 -O2 -pthread HugePageBenchmark.cpp -o HugePageBenchmark
+//     ./HugePageBenchmark [heap|hugepage|both] [values, default 20000000] [threads, default 1]
+//
+// Running one storage at a time under perf shows where the difference
+// comes from, for example
+//
+//     perf stat -e dTLB-loads,dTLB-load-misses,page-faults ./HugePageBenchmark heap
+//     perf stat -e dTLB-loads,dTLB-load-misses,page-faults ./HugePageBenchmark hugepage
+//
+// Each thread builds its own list, interleaving its values with those of
+// a second list that is thrown away once filling ends, so that the nodes of the
+// list being scanned aren't simply laid out one after another.
+
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    struct Timings
+    {
+        double fill;
+        double scan;
+        double clear;
+    };
+
+
+    // Runs each phase on every thread at once, timing it from the first thread starting to the last one finishing.
+    template <typename NodeStorage>
+    Timings run(unsigned long values, unsigned int threadCount)
+    {
+        using List = DoublyLinkedList<long, NodeStorage>;
+
+        std::vector<List> lists(threadCount);
+        std::vector<long> sums(threadCount);
+        unsigned long valuesPerThread = values / threadCount;
+        Timings timings;
+
+        timings.fill = inParallel(threadCount, [&lists, valuesPerThread](unsigned int thread)
+        {
+            List spacer;
+
+            for (unsigned long i = 0; i < valuesPerThread; i++)
+            {
+                lists[thread].addToEnd(static_cast<long>(i));
+                spacer.addToEnd(static_cast<long>(i));
+            }
+        });
+
+        timings.scan = inParallel(threadCount, [&lists, &sums](unsigned int thread)
+        {
+            long sum = 0;
+            lists[thread].forEach([&sum](long value) { sum += value; });
+            sums[thread] = sum;
+        });
+
+        timings.clear = inParallel(threadCount, [&lists](unsigned int thread)
+        {
+            lists[thread].clear();
+        });
+
+        return timings;
+    }
+
+
+    template <typename NodeStorage>
+    void report(const char* name, unsigned long values, unsigned int threadCount)
+    {
+        Timings timings = run<NodeStorage>(values, threadCount);
+
+        std::printf("%-9s fill %7.3f s  scan %7.3f s (%6.1f M values/s)  clear %7.3f s\n", name, timings.fill, timings.scan,
+            values / timings.scan / 1e6, timings.clear);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    const char* storage = (argc > 1) ? argv[1] : "both";
+    unsigned long values = argumentOr(argc, argv, 2, 20000000);
+    unsigned int threadCount = static_cast<unsigned int>(argumentOr(argc, argv, 3, 1));
+
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+
+    std::printf("%lu values, %u thread(s)\n", values, threadCount);
+
+    if (std::strcmp(storage, "heap") == 0 || std::strcmp(storage, "both") == 0)
+    {
+        report<HeapNodeStorage>("heap", values, threadCount);
+    }
+
+    if (std::strcmp(storage, "hugepage") == 0 || std::strcmp(storage, "both") == 0)
+    {
+        report<HugePageNodeStorage>("hugepage", values, threadCount);
+    }
+
+    return 0;
+}
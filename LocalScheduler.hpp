@@ -0,0 +1,327 @@
+// LocalScheduler.hpp
+// A small single-threaded scheduler for C++20 coroutines, mostly meant
+// for testing code that uses AsyncQueue.
+//
+// Coroutines written to return a LocalTask don't start running when they
+// are called; instead, they are given to spawn(), which schedules them.
+// run() then resumes scheduled coroutines in the order they were
+// scheduled, until there are none left.  A LocalScheduler's schedule()
+// member function can be given to an AsyncQueue, so that coroutines
+// waiting on the queue are resumed by run() rather than inside the call
+// that woke them.
+//
+//     LocalScheduler scheduler;
+//     AsyncQueue<int> queue{[&](std::coroutine_handle<> h) { scheduler.schedule(h); }};
+//
+// A LocalTask owns its coroutine frame until it is given to spawn(), and
+// destroys it if it never is.  From then on the scheduler owns it: the
+// frame is destroyed when the coroutine finishes, or by clear() or the
+// scheduler's destructor if it hasn't finished by then, whether it is
+// still scheduled or suspended somewhere else (such as on an AsyncQueue).
+// An exception that escapes a LocalTask ends the program.
+
+
+#ifndef LOCALSCHEDULER_HPP
+#define LOCALSCHEDULER_HPP
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include "DoublyLinkedList.hpp"
+
+
+
+class LocalScheduler;
+
+
+
+class LocalTask
+{
+public:
+    struct promise_type
+    {
+        LocalTask get_return_object() noexcept
+        {
+            return LocalTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        // Wait to be spawned rather than running straight away.
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        // Nobody waits on a finished task, so let the frame go.
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+
+        // Tells the scheduler that owns the task, if any, that its frame is
+        // going away.
+        ~promise_type();
+
+        // The scheduler the task was spawned on, and its neighbours in that
+        // scheduler's list of tasks that haven't finished.
+        LocalScheduler* owner = nullptr;
+        promise_type* previousTask = nullptr;
+        promise_type* nextTask = nullptr;
+    };
+
+
+    // A LocalTask owns its coroutine frame, so it can be moved but not
+    // copied.
+    LocalTask(LocalTask&& task) noexcept;
+    LocalTask& operator=(LocalTask&& task) noexcept;
+
+    LocalTask(const LocalTask& task) = delete;
+    LocalTask& operator=(const LocalTask& task) = delete;
+
+
+    // Destroys the coroutine frame if the task was never spawned.
+    ~LocalTask();
+
+
+private:
+    explicit LocalTask(std::coroutine_handle<promise_type> coroutine) noexcept;
+
+    friend class LocalScheduler;
+
+    // The coroutine that hasn't started yet, or nullptr once it has been
+    // spawned or moved away.
+    std::coroutine_handle<promise_type> coroutine;
+};
+
+
+
+class LocalScheduler
+{
+public:
+    LocalScheduler() noexcept;
+
+
+    // Spawned tasks refer back to their scheduler, so it can neither be
+    // copied nor moved.
+    LocalScheduler(const LocalScheduler& scheduler) = delete;
+    LocalScheduler& operator=(const LocalScheduler& scheduler) = delete;
+
+
+    // Destroys every task that hasn't finished, as clear() does.
+    ~LocalScheduler();
+
+
+    // schedule() arranges for the coroutine to be resumed by run().
+    void schedule(std::coroutine_handle<> handle);
+
+
+    // spawn() takes ownership of a task that hasn't started yet and
+    // schedules it, so that run() starts it.  In the event that an
+    // exception has been thrown, the task was destroyed without running.
+    void spawn(LocalTask task);
+
+
+    // run() resumes scheduled coroutines, in the order they were
+    // scheduled, until none are left.  Coroutines scheduled while it is
+    // running are resumed too.
+    void run();
+
+
+    // clear() unschedules every coroutine and destroys every task spawned
+    // here that hasn't finished, started or not.  Coroutines that aren't
+    // LocalTasks are unscheduled but not destroyed.  It must not be called
+    // from inside one of this scheduler's tasks.
+    void clear() noexcept;
+
+
+    // isIdle() returns true if no coroutines are scheduled, false otherwise.
+    bool isIdle() const noexcept;
+
+    // taskCount() returns the number of tasks spawned here that haven't
+    // finished.
+    unsigned int taskCount() const noexcept;
+
+
+private:
+    friend struct LocalTask::promise_type;
+
+    // Unlinks a task whose frame is being destroyed.
+    void forget(LocalTask::promise_type& task) noexcept;
+
+
+    DoublyLinkedList<std::coroutine_handle<>> ready;
+    LocalTask::promise_type* tasks;
+    unsigned int unfinished;
+};
+
+
+
+//
+// LocalTask member functions //
+//
+
+
+// Only the scheduler that owns the task is told; a task that was never spawned has none.
+inline LocalTask::promise_type::~promise_type()
+{
+    if (owner != nullptr)
+    {
+        owner->forget(*this);
+    }
+}
+
+
+inline LocalTask::LocalTask(std::coroutine_handle<promise_type> coroutine) noexcept
+    : coroutine{coroutine}
+{
+}
+
+
+// Move constructor
+inline LocalTask::LocalTask(LocalTask&& task) noexcept
+    : coroutine{std::exchange(task.coroutine, nullptr)}
+{
+}
+
+
+// Move assignment operator
+inline LocalTask& LocalTask::operator=(LocalTask&& task) noexcept
+{
+    if (this != &task)
+    {
+        if (coroutine)
+        {
+            coroutine.destroy();
+        }
+
+        coroutine = std::exchange(task.coroutine, nullptr);
+    }
+
+    return *this;
+}
+
+
+// Destructor
+inline LocalTask::~LocalTask()
+{
+    if (coroutine)
+    {
+        coroutine.destroy();
+    }
+}
+
+
+
+//
+// LocalScheduler member functions //
+//
+
+
+// Constructor
+inline LocalScheduler::LocalScheduler() noexcept
+    : ready{}, tasks{nullptr}, unfinished{0}
+{
+}
+
+
+// Destructor
+inline LocalScheduler::~LocalScheduler()
+{
+    clear();
+}
+
+
+inline void LocalScheduler::schedule(std::coroutine_handle<> handle)
+{
+    ready.addToEnd(handle);
+}
+
+
+// The task keeps its frame until it has been scheduled, so a failure to schedule it destroys it.
+inline void LocalScheduler::spawn(LocalTask task)
+{
+    schedule(task.coroutine);
+
+    LocalTask::promise_type& promise = task.coroutine.promise();
+    task.coroutine = nullptr;
+
+    promise.owner = this;
+    promise.nextTask = tasks;
+
+    if (tasks != nullptr)
+    {
+        tasks->previousTask = &promise;
+    }
+
+    tasks = &promise;
+    unfinished++;
+}
+
+
+inline void LocalScheduler::run()
+{
+    while (ready.isEmpty() == false)
+    {
+        std::coroutine_handle<> handle = ready.first();
+        ready.removeFromStart();
+
+        handle.resume();
+    }
+}
+
+
+// Destroying a task's frame unlinks it through forget(); the frames are destroyed before
+// unscheduling, in case destroying one schedules something.
+inline void LocalScheduler::clear() noexcept
+{
+    while (tasks != nullptr)
+    {
+        std::coroutine_handle<LocalTask::promise_type>::from_promise(*tasks).destroy();
+    }
+
+    ready.clear();
+}
+
+
+inline bool LocalScheduler::isIdle() const noexcept
+{
+    return ready.isEmpty();
+}
+
+
+inline unsigned int LocalScheduler::taskCount() const noexcept
+{
+    return unfinished;
+}
+
+
+inline void LocalScheduler::forget(LocalTask::promise_type& task) noexcept
+{
+    if (task.previousTask != nullptr)
+    {
+        task.previousTask->nextTask = task.nextTask;
+    }
+    else
+    {
+        tasks = task.nextTask;
+    }
+
+    if (task.nextTask != nullptr)
+    {
+        task.nextTask->previousTask = task.previousTask;
+    }
+
+    unfinished--;
+}
+
+
+
+#endif
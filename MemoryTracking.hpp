@@ -0,0 +1,132 @@
+// MemoryTracking.hpp
+// Support for finding out how much memory the containers in this project
+// are using.
+//
+// MemoryFootprint describes the memory one container is using, broken
+// down into the bytes that hold its values and the bytes it needs on top
+// of that (links between nodes, padding, and the container object
+// itself).  It only counts memory the container allocates itself; memory
+// that the values allocate for their own use, such as the characters of
+// a long std::string, isn't included.
+//
+// A MemoryTracker, once installed with setMemoryTracker(), is told about
+// every node the containers allocate and deallocate, across all of them,
+// which makes it possible to check a footprint against what actually
+// happened, or to keep a running total for a whole process.  When no
+// tracker is installed, the only cost is one check per allocation.
+
+
+#ifndef MEMORYTRACKING_HPP
+#define MEMORYTRACKING_HPP
+
+#include <atomic>
+#include <cstddef>
+
+
+
+struct MemoryFootprint
+{
+    // Bytes allocated for nodes, including everything inside them.
+    std::size_t nodeBytes;
+
+    // Bytes of nodeBytes that hold the values themselves.
+    std::size_t payloadBytes;
+
+    // Bytes needed beyond the values: the links and padding inside each
+    // node, plus the container object itself.
+    std::size_t overheadBytes;
+
+    // Bytes reserved from the system for nodes that aren't currently in
+    // use, in storage that holds on to freed nodes for reuse; 0 otherwise.
+    std::size_t reservedUnusedBytes;
+
+    // totalBytes() returns every byte counted above: the nodes, the
+    // container object and any reserved but unused node storage.
+    std::size_t totalBytes() const noexcept
+    {
+        return overheadBytes + payloadBytes + reservedUnusedBytes;
+    }
+};
+
+
+
+class MemoryTracker
+{
+public:
+    virtual ~MemoryTracker() = default;
+
+    // allocated() is called after a block of the given number of bytes
+    // has been allocated.
+    virtual void allocated(std::size_t bytes) noexcept = 0;
+
+    // deallocated() is called after a block of the given number of bytes
+    // has been deallocated.
+    virtual void deallocated(std::size_t bytes) noexcept = 0;
+};
+
+
+
+// A MemoryTracker that simply keeps count, safe to share between threads.
+class CountingMemoryTracker : public MemoryTracker
+{
+public:
+    void allocated(std::size_t bytes) noexcept override
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        std::size_t inUse = bytesInUse.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+        std::size_t peak = peakBytes.load(std::memory_order_relaxed);
+        while (inUse > peak && peakBytes.compare_exchange_weak(peak, inUse, std::memory_order_relaxed) == false)
+        {
+        }
+    }
+
+    void deallocated(std::size_t bytes) noexcept override
+    {
+        deallocationCount.fetch_add(1, std::memory_order_relaxed);
+        bytesInUse.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::size_t> bytesInUse{0};
+    std::atomic<std::size_t> peakBytes{0};
+    std::atomic<std::size_t> allocationCount{0};
+    std::atomic<std::size_t> deallocationCount{0};
+};
+
+
+
+// The installed tracker, or nullptr if there isn't one.
+inline std::atomic<MemoryTracker*> installedMemoryTracker{nullptr};
+
+
+// setMemoryTracker() installs the given tracker (or uninstalls the current
+// one, given nullptr) and returns the one that was installed before.  The
+// tracker must stay alive until it has been uninstalled.
+inline MemoryTracker* setMemoryTracker(MemoryTracker* tracker) noexcept
+{
+    return installedMemoryTracker.exchange(tracker, std::memory_order_acq_rel);
+}
+
+
+// trackAllocation() and trackDeallocation() report to the installed
+// tracker, if there is one.
+inline void trackAllocation(std::size_t bytes) noexcept
+{
+    if (MemoryTracker* tracker = installedMemoryTracker.load(std::memory_order_acquire))
+    {
+        tracker->allocated(bytes);
+    }
+}
+
+inline void trackDeallocation(std::size_t bytes) noexcept
+{
+    if (MemoryTracker* tracker = installedMemoryTracker.load(std::memory_order_acquire))
+    {
+        tracker->deallocated(bytes);
+    }
+}
+
+
+
+#endif
+
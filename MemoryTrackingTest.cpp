@@ -0,0 +1,450 @@
+// MemoryTrackingTest.cpp
+// Checks the memory the containers report using, through memoryFootprint(),
+// against what they really allocated.  Lists of nodes get their nodes from
+// a CountingNodeStorage, which hands every call on to HeapNodeStorage or
+// HugePageNodeStorage and counts the bytes it has handed out; the global
+// operator new is replaced to do the same for ByteDoublyLinkedList, which
+// allocates its nodes with it directly.  Neither counter knows anything of
+// the containers, so a footprint that is wrong in any of its parts (nodes,
+// payload, overhead, or reserved but unused memory, including spare nodes
+// kept by clearKeepingNodes()) fails the check.  The installed
+// CountingMemoryTracker is checked against them too.  Last, a thread
+// that keeps using HugePageNodeStorage after its slot cache has been
+// destroyed at thread exit must still give every slot back to the pool.
+//
+//     g++ -std=c++17 -g -pthread -fsanitize=address,undefined MemoryTrackingTest.cpp -o MemoryTrackingTest
+//     ./MemoryTrackingTest
+//
+// The program prints each check as it passes, and aborts on the first one
+// that fails.
+
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "ByteDoublyLinkedList.hpp"
+#include "DoublyLinkedList.hpp"
+#include "MemoryTracking.hpp"
+#include "XorLinkedList.hpp"
+
+
+
+// Bytes handed out by operator new and not yet deleted, across the whole
+// program.  Each block is preceded by its size, so that operator delete
+// knows how many bytes are coming back.
+std::size_t heapBytesInUse = 0;
+
+
+void* operator new(std::size_t size)
+{
+    if (void* block = std::malloc(sizeof(std::max_align_t) + size))
+    {
+        *static_cast<std::size_t*>(block) = size;
+        heapBytesInUse += size;
+
+        return static_cast<unsigned char*>(block) + sizeof(std::max_align_t);
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void operator delete(void* block) noexcept
+{
+    if (block != nullptr)
+    {
+        void* start = static_cast<unsigned char*>(block) - sizeof(std::max_align_t);
+
+        heapBytesInUse -= *static_cast<std::size_t*>(start);
+        std::free(start);
+    }
+}
+
+
+void operator delete(void* block, std::size_t) noexcept
+{
+    operator delete(block);
+}
+
+
+
+namespace
+{
+    CountingMemoryTracker tracker;
+
+
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "MemoryTrackingTest: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    // A node storage that hands every call on to Storage, counting the bytes
+    // of the nodes it has handed out that haven't come back yet.  Chains are
+    // walked to check that they really hold the number of nodes they claim.
+    template <typename Storage>
+    class CountingNodeStorage
+    {
+    public:
+        template <std::size_t Size, std::size_t Alignment>
+        static void* allocate()
+        {
+            void* node = Storage::template allocate<Size, Alignment>();
+
+            bytesHeld += Size;
+            nodeSize = Size;
+            storageReservedUnusedBytes = &Storage::template reservedUnusedBytes<Size, Alignment>;
+            return node;
+        }
+
+
+        template <std::size_t Size, std::size_t Alignment>
+        static void deallocate(void* node) noexcept
+        {
+            bytesHeld -= Size;
+            Storage::template deallocate<Size, Alignment>(node);
+        }
+
+
+        static constexpr std::size_t nodesPerChain = Storage::nodesPerChain;
+
+        template <std::size_t Size, std::size_t Alignment>
+        static void deallocateChain(void* first, void* last, std::size_t count) noexcept
+        {
+            std::size_t walked = 1;
+            void* node = first;
+
+            while (static_cast<NodeChainLink*>(node)->next != nullptr)
+            {
+                node = static_cast<NodeChainLink*>(node)->next;
+                walked++;
+            }
+
+            require(node == last && walked == count && count <= nodesPerChain, "a chain that doesn't match its count");
+
+            bytesHeld -= count * Size;
+            Storage::template deallocateChain<Size, Alignment>(first, last, count);
+        }
+
+
+        template <std::size_t Size, std::size_t Alignment>
+        static std::size_t reservedUnusedBytes() noexcept
+        {
+            return Storage::template reservedUnusedBytes<Size, Alignment>();
+        }
+
+
+        static inline std::size_t bytesHeld = 0;
+
+        // The size of the nodes allocated, and what Storage reports as
+        // reserved but unused for that size, once a node has been allocated.
+        static inline std::size_t nodeSize = 0;
+        static inline std::size_t (*storageReservedUnusedBytes)() noexcept = nullptr;
+    };
+
+
+    // Checks every part of a list's footprint, given the bytes of node
+    // storage held by other lists alive at the same time, and the bytes of
+    // links each node must at least have.  Whatever the storage has handed
+    // out beyond the nodes of these lists must be the list's spare nodes.
+    template <typename Storage, typename List, typename ValueType>
+    void requireFootprint(const List& list, unsigned int spareNodes, std::size_t otherBytes, std::size_t linkBytes,
+        const char* what)
+    {
+        MemoryFootprint footprint = list.memoryFootprint();
+        std::size_t nodeBytes = list.size() * Storage::nodeSize;
+        std::size_t spareBytes = spareNodes * Storage::nodeSize;
+
+        require(nodeBytes + spareBytes + otherBytes == Storage::bytesHeld, what);
+        require(footprint.nodeBytes == nodeBytes, what);
+        require(footprint.payloadBytes == list.size() * sizeof(ValueType), what);
+        require(footprint.payloadBytes + footprint.overheadBytes == nodeBytes + sizeof(List), what);
+        require(footprint.overheadBytes >= list.size() * linkBytes + sizeof(List), what);
+
+        std::size_t storageBytes = Storage::storageReservedUnusedBytes == nullptr ? 0 : Storage::storageReservedUnusedBytes();
+        require(footprint.reservedUnusedBytes == storageBytes + spareBytes, what);
+        require(footprint.totalBytes() == nodeBytes + sizeof(List) + footprint.reservedUnusedBytes, what);
+
+        // The tracker sees every list's nodes, but takes spare nodes as deallocated.
+        require(tracker.bytesInUse.load() + spareBytes == Storage::bytesHeld, what);
+    }
+
+
+    // Runs a DoublyLinkedList through everything that allocates or
+    // deallocates nodes.  keepsFreedNodes says whether the storage holds on
+    // to nodes given back to it, as reserved but unused memory.
+    template <typename Storage, bool keepsFreedNodes>
+    void checkDoublyLinkedList(const char* storageName)
+    {
+        using Counting = CountingNodeStorage<Storage>;
+        using List = DoublyLinkedList<std::string, Counting>;
+        constexpr std::size_t linkBytes = 2 * sizeof(void*);
+
+        {
+            List list;
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "empty list");
+
+            for (int i = 0; i < 1000; i++)
+            {
+                list.addToEnd(std::to_string(i));
+                list.addToStart(std::to_string(-i));
+            }
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after adding to both ends");
+
+            for (int i = 0; i < 300; i++)
+            {
+                list.removeFromStart();
+                list.removeFromEnd();
+            }
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after removing from both ends");
+
+            {
+                typename List::Iterator iterator = list.iterator();
+
+                for (int i = 0; i < 100; i++)
+                {
+                    iterator.insertAfter("inserted");
+                    iterator.moveToNext();
+                    iterator.moveToNext();
+                }
+                for (int i = 0; i < 50; i++)
+                {
+                    iterator.remove(false);
+                }
+            }
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after inserting and removing through an iterator");
+
+            {
+                List copy{list};
+                requireFootprint<Counting, List, std::string>(copy, 0, list.size() * Counting::nodeSize, linkBytes, "after copying");
+
+                List shorter;
+                shorter.addToEnd("one");
+                copy = shorter;
+                requireFootprint<Counting, List, std::string>(copy, 0, (list.size() + 1) * Counting::nodeSize, linkBytes,
+                    "after assigning a shorter list");
+
+                copy = list;
+                requireFootprint<Counting, List, std::string>(copy, 0, (list.size() + 1) * Counting::nodeSize, linkBytes,
+                    "after assigning a longer list");
+            }
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after destroying the copies");
+
+            List other;
+            other.addToEnd("spliced");
+            list.spliceToEnd(other);
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after splicing");
+
+            list.relayout();
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after relayout()");
+
+            // Emptying a list this way hands no memory back; its nodes become reserved but unused.
+            unsigned int nodes = list.size();
+            std::size_t heldBefore = Counting::bytesHeld;
+            std::size_t reservedBefore = list.memoryFootprint().reservedUnusedBytes;
+
+            list.clearKeepingNodes();
+            require(Counting::bytesHeld == heldBefore, "clearKeepingNodes() gave nodes back");
+            require(list.memoryFootprint().reservedUnusedBytes == reservedBefore + nodes * Counting::nodeSize,
+                "clearKeepingNodes() didn't report its spare nodes");
+            requireFootprint<Counting, List, std::string>(list, nodes, 0, linkBytes, "after clearKeepingNodes()");
+
+            for (unsigned int i = 0; i < nodes / 2; i++)
+            {
+                list.addToEnd(std::to_string(i));
+            }
+            require(Counting::bytesHeld == heldBefore, "spare nodes weren't reused");
+            requireFootprint<Counting, List, std::string>(list, nodes - nodes / 2, 0, linkBytes, "after reusing spare nodes");
+
+            // Storage that keeps freed nodes goes on reporting them, so only the heap's reserved bytes go down.
+            reservedBefore = list.memoryFootprint().reservedUnusedBytes;
+            list.releaseSpareNodes();
+            require(Counting::bytesHeld == heldBefore - (nodes - nodes / 2) * Counting::nodeSize, "releaseSpareNodes() kept nodes");
+            require(list.memoryFootprint().reservedUnusedBytes
+                == (keepsFreedNodes == true ? reservedBefore : reservedBefore - (nodes - nodes / 2) * Counting::nodeSize),
+                "releaseSpareNodes() misreported the storage it gave back");
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after releaseSpareNodes()");
+
+            list.clearKeepingNodes();
+            list.clear();
+            require(Counting::bytesHeld == 0, "clear() kept nodes");
+            requireFootprint<Counting, List, std::string>(list, 0, 0, linkBytes, "after clear()");
+
+            list.addToEnd("last");
+        }
+        require(Counting::bytesHeld == 0 && tracker.bytesInUse.load() == 0, "after destroying a list");
+
+        std::printf("DoublyLinkedList with %s: passed\n", storageName);
+    }
+
+
+    template <typename Storage>
+    void checkXorLinkedList(const char* storageName)
+    {
+        using Counting = CountingNodeStorage<Storage>;
+        using List = XorLinkedList<int, Counting>;
+        constexpr std::size_t linkBytes = sizeof(void*);
+
+        {
+            List list;
+
+            for (int i = 0; i < 1000; i++)
+            {
+                list.addToEnd(i);
+                list.addToStart(-i);
+            }
+            requireFootprint<Counting, List, int>(list, 0, 0, linkBytes, "XorLinkedList after adding");
+
+            for (int i = 0; i < 300; i++)
+            {
+                list.removeFromStart();
+                list.removeFromEnd();
+            }
+            requireFootprint<Counting, List, int>(list, 0, 0, linkBytes, "XorLinkedList after removing");
+
+            {
+                List copy{list};
+                requireFootprint<Counting, List, int>(copy, 0, list.size() * Counting::nodeSize, linkBytes, "XorLinkedList after copying");
+            }
+            requireFootprint<Counting, List, int>(list, 0, 0, linkBytes, "XorLinkedList after destroying the copy");
+
+            list.clear();
+            requireFootprint<Counting, List, int>(list, 0, 0, linkBytes, "XorLinkedList after clear()");
+
+            list.addToEnd(1);
+        }
+        require(Counting::bytesHeld == 0 && tracker.bytesInUse.load() == 0, "after destroying an XorLinkedList");
+
+        std::printf("XorLinkedList with %s: passed\n", storageName);
+    }
+
+
+    // A value no other check uses, so that its nodes get a pool of their own.
+    struct WideValue
+    {
+        char bytes[40];
+    };
+
+    using WideList = DoublyLinkedList<WideValue, CountingNodeStorage<HugePageNodeStorage>>;
+
+
+    // Adds and removes values one at a time from its destructor.  Made
+    // thread_local before the thread's first node is allocated, it is
+    // destroyed after the thread's slot cache, as a static or thread_local
+    // list's owner might be.
+    struct ExitWork
+    {
+        WideList* list;
+
+        ~ExitWork()
+        {
+            for (int i = 0; i < 600; i++)
+            {
+                list->addToEnd(WideValue{});
+            }
+            for (int i = 0; i < 600; i++)
+            {
+                list->removeFromStart();
+            }
+        }
+    };
+
+
+    void checkUseAfterThreadExit()
+    {
+        WideList list;
+
+        std::thread thread{[&list]
+        {
+            thread_local ExitWork work{&list};
+
+            for (int i = 0; i < 600; i++)
+            {
+                list.addToEnd(WideValue{});
+            }
+            for (int i = 0; i < 600; i++)
+            {
+                list.removeFromEnd();
+            }
+        }};
+        thread.join();
+
+        // No node of this size is in use anywhere, and no live thread has a cache for them.
+        require(list.isEmpty() == true && CountingNodeStorage<HugePageNodeStorage>::bytesHeld == 0, "nodes left after thread exit");
+        require(list.memoryFootprint().reservedUnusedBytes == HugePageNodeStorage::blockBytes,
+            "slots used after the thread's cache was destroyed were lost");
+
+        std::printf("HugePageNodeStorage after thread exit: passed\n");
+    }
+
+
+    // Nothing else allocates between the counts taken here, so every byte
+    // operator new handed out in between is the list's.
+    void requireByteFootprint(const ByteDoublyLinkedList& list, std::size_t heapBytesBefore, std::size_t valueBytes, const char* what)
+    {
+        MemoryFootprint footprint = list.memoryFootprint();
+
+        require(footprint.nodeBytes == heapBytesInUse - heapBytesBefore, what);
+        require(footprint.payloadBytes == valueBytes, what);
+        require(footprint.payloadBytes + footprint.overheadBytes == footprint.nodeBytes + sizeof(ByteDoublyLinkedList), what);
+        require(footprint.overheadBytes >= list.size() * 2 * sizeof(void*) + sizeof(ByteDoublyLinkedList), what);
+        require(footprint.reservedUnusedBytes == 0, what);
+        require(tracker.bytesInUse.load() == footprint.nodeBytes, what);
+    }
+
+
+    void checkByteDoublyLinkedList()
+    {
+        static const char characters[97] = {};
+        std::size_t heapBytesBefore = heapBytesInUse;
+        std::size_t valueBytes = 0;
+
+        {
+            ByteDoublyLinkedList list;
+
+            for (int i = 0; i < 1000; i++)
+            {
+                std::size_t length = static_cast<std::size_t>(i % 97);
+
+                list.addToEndBytes(std::string_view{characters, length});
+                valueBytes += length;
+            }
+            requireByteFootprint(list, heapBytesBefore, valueBytes, "ByteDoublyLinkedList after adding");
+
+            for (int i = 0; i < 300; i++)
+            {
+                valueBytes -= list.first().size();
+                list.removeFromStart();
+            }
+            requireByteFootprint(list, heapBytesBefore, valueBytes, "ByteDoublyLinkedList after removing");
+        }
+        require(heapBytesInUse == heapBytesBefore && tracker.bytesInUse.load() == 0, "after destroying a ByteDoublyLinkedList");
+
+        std::printf("ByteDoublyLinkedList: passed\n");
+    }
+}
+
+
+
+int main()
+{
+    setMemoryTracker(&tracker);
+
+    checkDoublyLinkedList<HeapNodeStorage, false>("HeapNodeStorage");
+    checkDoublyLinkedList<HugePageNodeStorage, true>("HugePageNodeStorage");
+    checkXorLinkedList<HeapNodeStorage>("HeapNodeStorage");
+    checkXorLinkedList<HugePageNodeStorage>("HugePageNodeStorage");
+    checkByteDoublyLinkedList();
+    checkUseAfterThreadExit();
+
+    setMemoryTracker(nullptr);
+    return 0;
+}
@@ -0,0 +1,525 @@
+// NodeStorage.hpp
+// Where a DoublyLinkedList gets the memory for its nodes.
+//
+// A node storage is given as the second template argument of a
+// DoublyLinkedList, and provides
+//
+//     template <std::size_t Size, std::size_t Alignment>
+//     static void* allocate();
+//
+//     template <std::size_t Size, std::size_t Alignment>
+//     static void deallocate(void* node) noexcept;
+//
+//     template <std::size_t Size, std::size_t Alignment>
+//     static void deallocateChain(void* first, void* last, std::size_t count) noexcept;
+//
+//     template <std::size_t Size, std::size_t Alignment>
+//     static std::size_t reservedUnusedBytes() noexcept;
+//
+//     static constexpr std::size_t nodesPerChain;
+//
+// where allocate() returns memory for one node of the given size and
+// alignment (or throws std::bad_alloc), deallocate() gives it back, and
+// reservedUnusedBytes() reports how much memory the storage is holding on
+// to for nodes of that size without them being in use.
+//
+// deallocateChain() gives back count nodes at once, such as the nodes of
+// a list that is being cleared.  The nodes are linked into a chain from
+// first to last by a NodeChainLink written at the start of each one (the
+// last one's link is nullptr), so that storage that keeps freed nodes can
+// take the whole chain in one step rather than one node at a time.
+// nodesPerChain is the longest chain the storage wants to be given:
+// containers tearing down more nodes than that split them into several
+// chains.
+//
+// HeapNodeStorage, the default, allocates every node separately with
+// operator new.
+//
+// HugePageNodeStorage carves nodes out of 2MB blocks, so that a large
+// list spans a few hundred large pages rather than many thousands of
+// small ones, which keeps the processor's TLB from overflowing while
+// scanning it.  Each block is taken from explicit huge pages when the
+// system has some reserved, from transparent huge pages otherwise, and
+// from ordinary memory when neither is available (including on systems
+// other than Linux).  Blocks can also be bound to a particular NUMA node,
+// so that a list that is scanned by threads on one socket keeps its nodes
+// in that socket's memory no matter which thread allocated them.
+//
+// All lists using HugePageNodeStorage with the same node size share one
+// pool of blocks, guarded by a mutex.  Nodes that are deallocated are kept
+// for reuse by later nodes of the same size; the blocks themselves are
+// never given back to the system.  So that filling a large list doesn't
+// take the mutex once per node, each thread keeps a small cache of free
+// slots, which it refills from the pool and gives back to it in batches of
+// threadCacheBatch slots, and a chain passed to deallocateChain() is put
+// back on the pool's free list as a whole.  Slots sitting in a thread's
+// cache (at most twice threadCacheBatch per thread and node size) are
+// counted as in use by reservedUnusedBytes().  Once a thread's cache has
+// been destroyed at thread exit, anything the thread still allocates or
+// deallocates (such as a static or thread_local object's destructor
+// emptying a list one node at a time) goes straight to the pool.
+
+
+#ifndef NODESTORAGE_HPP
+#define NODESTORAGE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+
+// The link written at the start of each node in a chain given to
+// deallocateChain(), after the node itself has been destroyed.
+struct NodeChainLink
+{
+    void* next;
+};
+
+
+
+class HeapNodeStorage
+{
+public:
+    template <std::size_t Size, std::size_t Alignment>
+    static void* allocate()
+    {
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            return ::operator new(Size, std::align_val_t{Alignment});
+        }
+        else
+        {
+            return ::operator new(Size);
+        }
+    }
+
+
+    template <std::size_t Size, std::size_t Alignment>
+    static void deallocate(void* node) noexcept
+    {
+        if constexpr (Alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            ::operator delete(node, std::align_val_t{Alignment});
+        }
+        else
+        {
+            ::operator delete(node);
+        }
+    }
+
+
+    // The heap has no way to take many blocks at once, so they go back one
+    // at a time, and as soon as possible: freeing each node right after
+    // reading its link lets the work of freeing it overlap with the cache
+    // miss on the next node, where chains of more than one node would walk
+    // the nodes a second time.
+    static constexpr std::size_t nodesPerChain = 1;
+
+    template <std::size_t Size, std::size_t Alignment>
+    static void deallocateChain(void* first, void*, std::size_t) noexcept
+    {
+        while (first != nullptr)
+        {
+            void* next = static_cast<NodeChainLink*>(first)->next;
+            deallocate<Size, Alignment>(first);
+            first = next;
+        }
+    }
+
+
+    template <std::size_t Size, std::size_t Alignment>
+    static std::size_t reservedUnusedBytes() noexcept
+    {
+        return 0;
+    }
+};
+
+
+
+class HugePageNodeStorage
+{
+public:
+    // The size of each block that nodes are carved out of.
+    static constexpr std::size_t blockBytes = std::size_t{2} * 1024 * 1024;
+
+    // How many slots a thread's cache takes from, or gives back to, the
+    // shared pool at once.
+    static constexpr std::size_t threadCacheBatch = 256;
+
+    // The pool only needs the ends of a chain, so it takes a whole list's
+    // nodes at once.
+    static constexpr std::size_t nodesPerChain = static_cast<std::size_t>(-1);
+
+
+    // setNumaNode() binds blocks allocated from now on to the memory of the
+    // given NUMA node, or stops binding them if it is given -1 (the
+    // default).  If binding isn't possible, blocks are allocated unbound.
+    static void setNumaNode(int node) noexcept
+    {
+        numaNode().store(node, std::memory_order_relaxed);
+    }
+
+
+    template <std::size_t Size, std::size_t Alignment>
+    static void* allocate()
+    {
+        if (ThreadCache* cache = threadCache<Size, Alignment>())
+        {
+            return cache->allocate();
+        }
+
+        std::size_t taken;
+        return pool<Size, Alignment>().allocateChain(1, taken);
+    }
+
+
+    template <std::size_t Size, std::size_t Alignment>
+    static void deallocate(void* node) noexcept
+    {
+        if (ThreadCache* cache = threadCache<Size, Alignment>())
+        {
+            cache->deallocate(node);
+        }
+        else
+        {
+            FreeSlot* slot = static_cast<FreeSlot*>(node);
+            pool<Size, Alignment>().deallocateChain(slot, slot, 1);
+        }
+    }
+
+
+    template <std::size_t Size, std::size_t Alignment>
+    static void deallocateChain(void* first, void* last, std::size_t count) noexcept
+    {
+        if (count > 0)
+        {
+            pool<Size, Alignment>().deallocateChain(static_cast<FreeSlot*>(first), static_cast<FreeSlot*>(last), count);
+        }
+    }
+
+
+    // Bytes of blocks, allocated for nodes of this size, that aren't
+    // currently holding a node.
+    template <std::size_t Size, std::size_t Alignment>
+    static std::size_t reservedUnusedBytes() noexcept
+    {
+        return pool<Size, Alignment>().reservedUnusedBytes();
+    }
+
+
+private:
+    // A free slot, linked to the next one through its first word; the same
+    // layout as a NodeChainLink, so that a chain of nodes is already a list
+    // of free slots.
+    struct FreeSlot
+    {
+        FreeSlot* next;
+    };
+
+
+    // A pool of same-sized slots carved out of blocks.  Freed slots go on a
+    // free list, linked through the slots themselves.
+    class Pool
+    {
+    public:
+        explicit Pool(std::size_t slotBytes) noexcept
+            : slotBytes{slotBytes}, freeList{nullptr}, nextUnused{nullptr}, endOfBlock{nullptr}, reservedBytes{0}, slotsInUse{0}
+        {
+        }
+
+
+        // Takes up to count slots (at least one) and links them into a chain,
+        // returning its first slot and storing how many there are in taken.
+        FreeSlot* allocateChain(std::size_t count, std::size_t& taken)
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+
+            FreeSlot* first = freeList;
+            FreeSlot* last = nullptr;
+            taken = 0;
+
+            // Slots come off the free list as a run, and new slots are added after them in address order, so
+            // that a thread allocating several nodes in a row gets them laid out the way they were handed out.
+            while (taken < count && freeList != nullptr)
+            {
+                last = freeList;
+                freeList = freeList->next;
+                taken++;
+            }
+
+            while (taken < count)
+            {
+                if (nextUnused == nullptr || static_cast<std::size_t>(endOfBlock - nextUnused) < slotBytes)
+                {
+                    // Only a failure to get the first slot is an error; a partial batch will do.
+                    if (taken > 0)
+                    {
+                        break;
+                    }
+
+                    nextUnused = static_cast<unsigned char*>(allocateBlock());
+                    endOfBlock = nextUnused + blockBytes;
+                    reservedBytes += blockBytes;
+                }
+
+                FreeSlot* slot = reinterpret_cast<FreeSlot*>(nextUnused);
+                nextUnused += slotBytes;
+
+                if (last == nullptr)
+                {
+                    first = slot;
+                }
+                else
+                {
+                    last->next = slot;
+                }
+
+                last = slot;
+                taken++;
+            }
+
+            last->next = nullptr;
+            slotsInUse += taken;
+            return first;
+        }
+
+
+        // Puts a chain of count slots, from first to last, back on the free
+        // list.
+        void deallocateChain(FreeSlot* first, FreeSlot* last, std::size_t count) noexcept
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+
+            last->next = freeList;
+            freeList = first;
+
+            slotsInUse -= count;
+        }
+
+
+        std::size_t reservedUnusedBytes() noexcept
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            return reservedBytes - slotsInUse * slotBytes;
+        }
+
+
+    private:
+        std::mutex mutex;
+        std::size_t slotBytes;
+        FreeSlot* freeList;
+        unsigned char* nextUnused;
+        unsigned char* endOfBlock;
+        std::size_t reservedBytes;
+        std::size_t slotsInUse;
+    };
+
+
+    // One thread's cache of free slots from one pool.  Whatever is left in
+    // it goes back to the pool when the thread exits, and destroyed is set
+    // so that the thread stops using it.
+    class ThreadCache
+    {
+    public:
+        ThreadCache(Pool& pool, bool& destroyed) noexcept
+            : cachePool{pool}, slots{nullptr}, slotCount{0}, destroyed{destroyed}
+        {
+        }
+
+
+        ThreadCache(const ThreadCache&) = delete;
+        ThreadCache& operator=(const ThreadCache&) = delete;
+
+
+        ~ThreadCache()
+        {
+            if (slotCount > 0)
+            {
+                giveBack(slotCount);
+            }
+
+            destroyed = true;
+        }
+
+
+        void* allocate()
+        {
+            if (slots == nullptr)
+            {
+                slots = cachePool.allocateChain(threadCacheBatch, slotCount);
+            }
+
+            FreeSlot* slot = slots;
+            slots = slots->next;
+            slotCount--;
+
+            return slot;
+        }
+
+
+        void deallocate(void* slot) noexcept
+        {
+            FreeSlot* freeSlot = static_cast<FreeSlot*>(slot);
+            freeSlot->next = slots;
+            slots = freeSlot;
+            slotCount++;
+
+            // Keeping one batch back means a thread that adds and removes around a batch boundary doesn't go to the pool every time.
+            if (slotCount >= 2 * threadCacheBatch)
+            {
+                giveBack(threadCacheBatch);
+            }
+        }
+
+
+    private:
+        // Gives the first count cached slots back to the pool.
+        void giveBack(std::size_t count) noexcept
+        {
+            FreeSlot* first = slots;
+            FreeSlot* last = first;
+
+            for (std::size_t i = 1; i < count; i++)
+            {
+                last = last->next;
+            }
+
+            slots = last->next;
+            slotCount -= count;
+
+            cachePool.deallocateChain(first, last, count);
+        }
+
+
+        Pool& cachePool;
+        FreeSlot* slots;
+        std::size_t slotCount;
+        bool& destroyed;
+    };
+
+
+    // The pool for nodes of this size.  It is never destroyed, so that lists
+    // that are themselves destroyed during program exit can still use it.
+    template <std::size_t Size, std::size_t Alignment>
+    static Pool& pool() noexcept
+    {
+        // Every slot has to be able to hold a free list link, and has to
+        // keep the slot after it aligned.
+        constexpr std::size_t slotAlignment = Alignment > alignof(void*) ? Alignment : alignof(void*);
+        constexpr std::size_t minimumBytes = Size > sizeof(void*) ? Size : sizeof(void*);
+        constexpr std::size_t slotBytes = (minimumBytes + slotAlignment - 1) / slotAlignment * slotAlignment;
+
+        static_assert(slotBytes <= blockBytes, "HugePageNodeStorage can't hold nodes larger than a block");
+
+        static Pool* thePool = new Pool{slotBytes};
+        return *thePool;
+    }
+
+
+    // This thread's cache for the pool for nodes of this size, or nullptr
+    // once it has been destroyed at thread exit, after which callers go to
+    // the pool instead.  The flag has no destructor, so it can still be
+    // read after the cache is gone, by destructors that run later.
+    template <std::size_t Size, std::size_t Alignment>
+    static ThreadCache* threadCache() noexcept
+    {
+        thread_local bool destroyed = false;
+
+        if (destroyed == true)
+        {
+            return nullptr;
+        }
+
+        thread_local ThreadCache cache{pool<Size, Alignment>(), destroyed};
+        return &cache;
+    }
+
+
+    static std::atomic<int>& numaNode() noexcept
+    {
+        static std::atomic<int> node{-1};
+        return node;
+    }
+
+
+    // Allocates one block, aligned to its own size, trying explicit huge
+    // pages, then transparent huge pages, then ordinary memory.
+    static void* allocateBlock()
+    {
+#if defined(__linux__)
+        void* block = mmap(nullptr, blockBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+        if (block == MAP_FAILED)
+        {
+            // Over-allocate so that an aligned block fits inside, then give back the excess on either side.
+            void* region = mmap(nullptr, 2 * blockBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (region == MAP_FAILED)
+            {
+                throw std::bad_alloc{};
+            }
+
+            std::uintptr_t regionStart = reinterpret_cast<std::uintptr_t>(region);
+            std::uintptr_t blockStart = (regionStart + blockBytes - 1) / blockBytes * blockBytes;
+
+            if (blockStart > regionStart)
+            {
+                munmap(region, blockStart - regionStart);
+            }
+
+            std::uintptr_t regionEnd = regionStart + 2 * blockBytes;
+            if (regionEnd > blockStart + blockBytes)
+            {
+                munmap(reinterpret_cast<void*>(blockStart + blockBytes), regionEnd - (blockStart + blockBytes));
+            }
+
+            block = reinterpret_cast<void*>(blockStart);
+
+#if defined(MADV_HUGEPAGE)
+            madvise(block, blockBytes, MADV_HUGEPAGE);
+#endif
+        }
+
+        // The block hasn't been touched yet, so binding it now decides where its pages will live.
+        bindToNumaNode(block);
+
+        return block;
+#else
+        return ::operator new(blockBytes, std::align_val_t{blockBytes});
+#endif
+    }
+
+
+    // Binds the block to the chosen NUMA node, if there is one.  Failing to
+    // bind (for example, on a kernel without NUMA support) is not an error.
+    static void bindToNumaNode(void* block) noexcept
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        int node = numaNode().load(std::memory_order_relaxed);
+
+        if (node >= 0 && node < static_cast<int>(8 * sizeof(unsigned long)))
+        {
+            constexpr int bindPolicy = 2; // MPOL_BIND, from <numaif.h>.
+            unsigned long nodeMask = 1UL << node;
+
+            syscall(SYS_mbind, block, blockBytes, bindPolicy, &nodeMask, 8 * sizeof(unsigned long), 0);
+        }
+#else
+        (void)block;
+#endif
+    }
+};
+
+
+
+#endif
+
@@ -0,0 +1,88 @@
+// RotateBenchmark.cpp
+// Measures round-robin scheduler rotations per second: moving the first
+// task to the back by copying it (first(), removeFromStart(), addToEnd()),
+// against rotateLeft(1), which only relinks nodes.  Also measures
+// reverse() on a large list.
+//
+//     g++ -std=c++17 -O2 RotateBenchmark.cpp -o RotateBenchmark
+//     ./RotateBenchmark [rotations, default 10000000]
+//
+// Tasks are an int and a name long enough that std::string keeps it on
+// the heap, as a scheduler's tasks usually carry something that does.
+
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    struct Task
+    {
+        int id;
+        std::string name;
+    };
+
+
+    void measure(unsigned int taskCount, unsigned long rotations)
+    {
+        DoublyLinkedList<Task> tasks;
+        for (unsigned int i = 0; i < taskCount; i++)
+        {
+            tasks.addToEnd(Task{static_cast<int>(i), "a task with a long enough name #" + std::to_string(i)});
+        }
+
+        long check = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < rotations; i++)
+        {
+            Task task = tasks.first();
+            tasks.removeFromStart();
+            tasks.addToEnd(task);
+            check += tasks.first().id;
+        }
+        double copying = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned long i = 0; i < rotations; i++)
+        {
+            tasks.rotateLeft(1);
+            check -= tasks.first().id;
+        }
+        double relinking = secondsSince(start);
+
+        std::printf("%7u tasks   copying %7.1f M rotations/s   rotateLeft(1) %7.1f M rotations/s%s\n", taskCount,
+            rotations / copying / 1e6, rotations / relinking / 1e6, check == 0 ? "" : "  (orders differ!)");
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long rotations = argumentOr(argc, argv, 1, 10000000);
+
+    std::printf("%lu rotations\n", rotations);
+
+    for (unsigned int taskCount = 16; taskCount <= 100000; taskCount *= 25)
+    {
+        measure(taskCount, rotations);
+    }
+
+    DoublyLinkedList<int> large;
+    for (int i = 0; i < 10000000; i++)
+    {
+        large.addToEnd(i);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    large.reverse();
+    std::printf("reverse() of 10M values: %.3f s\n", secondsSince(start));
+
+    return 0;
+}
@@ -0,0 +1,289 @@
+// ShardedList.hpp
+// A thread-safe list for workloads where many threads add values at
+// once and the values are collected together later.
+//
+// Rather than sharing a single DoublyLinkedList (and its lock) between
+// every thread, a ShardedList keeps a number of shards, each of which is
+// a DoublyLinkedList with its own lock.  Every thread is assigned a shard
+// of its own the first time it adds a value to a list, and always adds to
+// that same shard; when the thread exits, the shard is free to be given
+// to another one.  So as long as there are at least as many shards as
+// threads adding at the same time, no two threads ever share a shard or
+// wait on the same lock, however many threads have come and gone before.
+// When there are more adding threads than shards, the extra ones share
+// the shards that have the fewest threads on them, and contend for their
+// locks.  The shards sit on separate cache lines so that threads adding
+// to neighbouring shards don't slow each other down either.
+//
+// drainAll() splices every shard onto the end of a single list, which
+// takes time proportional to the number of shards, not the number of
+// values.  The values added by any one thread stay in the order that
+// thread added them, but there is no order between values added by
+// different threads.
+
+
+#ifndef SHARDEDLIST_HPP
+#define SHARDEDLIST_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "DoublyLinkedList.hpp"
+
+
+
+template <typename ValueType>
+class ShardedList
+{
+public:
+    // Initializes this list to be empty, with the given number of shards.
+    // By default there is one shard per hardware thread.
+    explicit ShardedList(unsigned int shardCount = std::thread::hardware_concurrency());
+
+
+    // A ShardedList is shared between threads by reference, so it can
+    // neither be copied nor moved.
+    ShardedList(const ShardedList& list) = delete;
+    ShardedList& operator=(const ShardedList& list) = delete;
+
+
+    // addToEnd() adds a value to the end of the calling thread's shard.
+    // In the event that an exception has been thrown, the value was not
+    // added.
+    void addToEnd(const ValueType& value);
+
+
+    // drainAll() removes every value from every shard and returns them in
+    // a single list, shard by shard.  Values added while it runs either
+    // make it into the returned list or stay behind for the next call;
+    // none are lost.
+    DoublyLinkedList<ValueType> drainAll();
+
+
+    // size() returns the number of values across all of the shards.  Since
+    // other threads may be adding values meanwhile, it is only a snapshot.
+    unsigned int size() const;
+
+
+    // shardCount() returns the number of shards.
+    unsigned int shardCount() const noexcept;
+
+
+    // shardIndex() returns the index of the shard the calling thread adds
+    // to, assigning it one (as addToEnd() would) if it doesn't have one yet.
+    unsigned int shardIndex() const;
+
+
+private:
+    // Each shard gets its own cache line, so that locking one doesn't
+    // invalidate the line holding its neighbour.
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        DoublyLinkedList<ValueType> list;
+    };
+
+
+    // How many live threads have been assigned each shard.  It is shared
+    // with those threads, so that one exiting after the list is gone can
+    // still let go of its shard.
+    struct Holders
+    {
+        explicit Holders(unsigned int count);
+
+        std::unique_ptr<std::atomic<unsigned int>[]> counts;
+    };
+
+    // The shards one thread has been assigned, in every list it has added
+    // to; destroying it (when the thread exits) lets go of all of them.
+    struct ThreadShards
+    {
+        struct Assignment
+        {
+            std::uint64_t listId;
+            unsigned int index;
+            std::shared_ptr<Holders> holders;
+        };
+
+        ~ThreadShards();
+
+        std::vector<Assignment> assignments;
+    };
+
+    // Picks a shard with no live thread on it, or the one with the fewest
+    // if every shard has one, and counts the calling thread on it.
+    unsigned int claimShard() const noexcept;
+
+
+    std::unique_ptr<Shard[]> shards;
+    unsigned int count;
+    std::shared_ptr<Holders> holders;
+
+    // Tells this list's assignments apart from those of lists that have
+    // since been destroyed, whose addresses may be reused.
+    std::uint64_t id;
+};
+
+
+
+// Constructor
+template <typename ValueType>
+ShardedList<ValueType>::ShardedList(unsigned int shardCount)
+    : shards{}, count{shardCount == 0 ? 1 : shardCount}, holders{}, id{0}
+{
+    static std::atomic<std::uint64_t> nextId{1};
+
+    shards.reset(new Shard[count]);
+    holders = std::make_shared<Holders>(count);
+    id = nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+// Adds to the calling thread's shard under that shard's lock.
+template <typename ValueType>
+void ShardedList<ValueType>::addToEnd(const ValueType& value)
+{
+    Shard& shard = shards[shardIndex()];
+
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    shard.list.addToEnd(value);
+}
+
+
+// Splices every shard onto the end of a single list, one shard lock at a time.
+template <typename ValueType>
+DoublyLinkedList<ValueType> ShardedList<ValueType>::drainAll()
+{
+    DoublyLinkedList<ValueType> drained;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        std::lock_guard<std::mutex> lock{shards[i].mutex};
+        drained.spliceToEnd(shards[i].list);
+    }
+
+    return drained;
+}
+
+
+// Totals the shards' sizes, one shard lock at a time.
+template <typename ValueType>
+unsigned int ShardedList<ValueType>::size() const
+{
+    unsigned int total = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        std::lock_guard<std::mutex> lock{shards[i].mutex};
+        total += shards[i].list.size();
+    }
+
+    return total;
+}
+
+
+template <typename ValueType>
+unsigned int ShardedList<ValueType>::shardCount() const noexcept
+{
+    return count;
+}
+
+
+// Looks up the calling thread's assignment for this list, claiming a shard the first time.
+template <typename ValueType>
+unsigned int ShardedList<ValueType>::shardIndex() const
+{
+    thread_local ThreadShards threadShards;
+    std::vector<typename ThreadShards::Assignment>& assignments = threadShards.assignments;
+
+    // A thread mostly adds to the same list over and over, so that one is kept last and checked first.
+    for (std::size_t i = assignments.size(); i > 0; i--)
+    {
+        if (assignments[i - 1].listId == id)
+        {
+            if (i != assignments.size())
+            {
+                std::swap(assignments[i - 1], assignments.back());
+            }
+
+            return assignments.back().index;
+        }
+    }
+
+    // Forget lists that have been destroyed, which only this thread's assignment is still holding on to.
+    for (std::size_t i = 0; i < assignments.size(); )
+    {
+        if (assignments[i].holders.use_count() == 1)
+        {
+            std::swap(assignments[i], assignments.back());
+            assignments.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    // Room is made before claiming, so that a failed allocation doesn't leave a shard claimed.
+    assignments.reserve(assignments.size() + 1);
+    unsigned int index = claimShard();
+    assignments.push_back({id, index, holders});
+
+    return index;
+}
+
+
+// A free shard is taken with a compare-and-swap, so two threads can't both take the same one.
+template <typename ValueType>
+unsigned int ShardedList<ValueType>::claimShard() const noexcept
+{
+    unsigned int fewest = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        unsigned int free = 0;
+
+        if (holders->counts[i].compare_exchange_strong(free, 1, std::memory_order_relaxed) == true)
+        {
+            return i;
+        }
+        else if (free < holders->counts[fewest].load(std::memory_order_relaxed))
+        {
+            fewest = i;
+        }
+    }
+
+    holders->counts[fewest].fetch_add(1, std::memory_order_relaxed);
+    return fewest;
+}
+
+
+// Every shard starts out with no threads on it.
+template <typename ValueType>
+ShardedList<ValueType>::Holders::Holders(unsigned int count)
+    : counts{new std::atomic<unsigned int>[count]}
+{
+    for (unsigned int i = 0; i < count; i++)
+    {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+
+// Lets go of every shard this thread was assigned.
+template <typename ValueType>
+ShardedList<ValueType>::ThreadShards::~ThreadShards()
+{
+    for (Assignment& assignment : assignments)
+    {
+        assignment.holders->counts[assignment.index].fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+
+
+#endif
+
@@ -0,0 +1,63 @@
+// ShardedListBenchmark.cpp
+// Measures how adding to a ShardedList scales from 1 to 64 threads,
+// against every thread adding to one DoublyLinkedList behind one mutex.
+//
+//     g++ -std=c++17 -O2 -pthread ShardedListBenchmark.cpp -o ShardedListBenchmark
+//     ./ShardedListBenchmark [values per thread, default 1000000]
+//
+// The ShardedList is given one shard per thread, and its time includes
+// the drainAll() that collects its values into one list at the end.
+// Threads beyond the number of cores only add scheduling, so the numbers
+// stop meaning much past that point.
+
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include "BenchmarkUtil.hpp"
+#include "ShardedList.hpp"
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned int valuesPerThread = static_cast<unsigned int>(argumentOr(argc, argv, 1, 1000000));
+
+    std::printf("%u values per thread, %u hardware threads\n", valuesPerThread, std::thread::hardware_concurrency());
+
+    for (unsigned int threadCount = 1; threadCount <= 64; threadCount *= 2)
+    {
+        std::mutex mutex;
+        DoublyLinkedList<int> single;
+
+        double locked = inParallel(threadCount, [&mutex, &single, valuesPerThread](unsigned int)
+        {
+            for (unsigned int i = 0; i < valuesPerThread; i++)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                single.addToEnd(static_cast<int>(i));
+            }
+        });
+
+        ShardedList<int> sharded{threadCount};
+        double shardedSeconds = inParallel(threadCount, [&sharded, valuesPerThread](unsigned int)
+        {
+            for (unsigned int i = 0; i < valuesPerThread; i++)
+            {
+                sharded.addToEnd(static_cast<int>(i));
+            }
+        });
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        DoublyLinkedList<int> drained = sharded.drainAll();
+        shardedSeconds += secondsSince(start);
+
+        double total = static_cast<double>(threadCount) * valuesPerThread;
+
+        std::printf("%2u threads   one locked list %7.1f M adds/s   ShardedList %7.1f M adds/s%s\n", threadCount,
+            total / locked / 1e6, total / shardedSeconds / 1e6, drained.size() == single.size() ? "" : "  (sizes differ!)");
+    }
+
+    return 0;
+}
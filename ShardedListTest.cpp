@@ -0,0 +1,231 @@
+// ShardedListTest.cpp
+// Checks that no value added to a ShardedList is lost or duplicated while
+// other threads keep draining it, and that each thread's values come out
+// in the order it added them.  Also checks how threads are spread over the
+// shards as more of them add at once: no two live threads should share a
+// shard until there are more of them than shards, even after earlier
+// threads have come and gone and while other threads add to other lists.
+//
+//     g++ -std=c++17 -g -O1 -fsanitize=thread -pthread ShardedListTest.cpp -o ShardedListTest
+//     ./ShardedListTest
+//
+// The program prints each check as it passes, and aborts on the first one
+// that fails.
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "ShardedList.hpp"
+
+
+
+namespace
+{
+    constexpr unsigned int appenderCount = 8;
+    constexpr unsigned int valuesPerAppender = 50000;
+
+
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "ShardedListTest: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    // Each value encodes which appender added it and in what position.
+    unsigned int valueFor(unsigned int appender, unsigned int position)
+    {
+        return appender * valuesPerAppender + position;
+    }
+
+
+    // Marks every value of a drained list as seen, checking that it hasn't
+    // been seen before and that each appender's values keep their order.
+    void collect(const DoublyLinkedList<unsigned int>& drained, std::vector<unsigned char>& seen, std::vector<long>& lastPosition)
+    {
+        drained.forEach([&seen, &lastPosition](unsigned int value)
+        {
+            require(value < seen.size(), "a value that was never added");
+            require(seen[value] == 0, "a value drained twice");
+            seen[value] = 1;
+
+            unsigned int appender = value / valuesPerAppender;
+            long position = static_cast<long>(value % valuesPerAppender);
+
+            require(position > lastPosition[appender], "an appender's values out of order");
+            lastPosition[appender] = position;
+        });
+    }
+
+
+    // Runs the appenders against drainerCount threads calling drainAll() in
+    // a loop, then drains whatever is left.
+    void checkConcurrentDrain(unsigned int shardCount, unsigned int drainerCount)
+    {
+        ShardedList<unsigned int> list{shardCount};
+        std::atomic<unsigned int> appendersRunning{appenderCount};
+        std::vector<std::vector<DoublyLinkedList<unsigned int>>> drainedByThread(drainerCount);
+
+        std::vector<std::thread> threads;
+
+        for (unsigned int appender = 0; appender < appenderCount; appender++)
+        {
+            threads.emplace_back([&list, &appendersRunning, appender]
+            {
+                for (unsigned int position = 0; position < valuesPerAppender; position++)
+                {
+                    list.addToEnd(valueFor(appender, position));
+                }
+
+                appendersRunning.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        for (unsigned int drainer = 0; drainer < drainerCount; drainer++)
+        {
+            threads.emplace_back([&list, &appendersRunning, &drainedByThread, drainer]
+            {
+                while (appendersRunning.load(std::memory_order_acquire) > 0)
+                {
+                    drainedByThread[drainer].push_back(list.drainAll());
+                    (void)list.size();
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        DoublyLinkedList<unsigned int> rest = list.drainAll();
+        require(list.size() == 0, "values left behind after the final drainAll()");
+
+        // Drains by different threads can interleave, so order is only checked within each drained list.
+        std::vector<unsigned char> seen(appenderCount * valuesPerAppender, 0);
+        unsigned int drainCalls = 0;
+
+        for (const std::vector<DoublyLinkedList<unsigned int>>& drained : drainedByThread)
+        {
+            for (const DoublyLinkedList<unsigned int>& each : drained)
+            {
+                std::vector<long> lastPosition(appenderCount, -1);
+                collect(each, seen, lastPosition);
+                drainCalls++;
+            }
+        }
+
+        std::vector<long> lastPosition(appenderCount, -1);
+        collect(rest, seen, lastPosition);
+
+        unsigned int recovered = 0;
+        for (unsigned char each : seen)
+        {
+            recovered += each;
+        }
+
+        require(recovered == appenderCount * valuesPerAppender, "a value was lost");
+
+        std::printf("%u shards, %u drainers: %u/%u values recovered over %u drains\n", shardCount, drainerCount, recovered,
+            appenderCount * valuesPerAppender, drainCalls + 1);
+    }
+
+
+    // Starts threadCount threads that each find their shard and then wait
+    // for the others, so that all of them are alive at once, and returns
+    // how many of them had to share a shard with another.  Alongside each
+    // one runs a thread that only adds to the other list, which mustn't
+    // change which shards this one gives out.
+    unsigned int countSharedShards(ShardedList<unsigned int>& list, ShardedList<unsigned int>& other, unsigned int threadCount)
+    {
+        std::vector<unsigned int> indexes(threadCount);
+        std::atomic<unsigned int> arrived{0};
+        std::vector<std::thread> threads;
+
+        for (unsigned int thread = 0; thread < threadCount; thread++)
+        {
+            threads.emplace_back([&other, &arrived, thread, threadCount]
+            {
+                other.addToEnd(thread);
+
+                arrived.fetch_add(1, std::memory_order_acq_rel);
+                while (arrived.load(std::memory_order_acquire) < 2 * threadCount)
+                {
+                    std::this_thread::yield();
+                }
+            });
+
+            threads.emplace_back([&list, &indexes, &arrived, thread, threadCount]
+            {
+                list.addToEnd(thread);
+                indexes[thread] = list.shardIndex();
+
+                arrived.fetch_add(1, std::memory_order_acq_rel);
+                while (arrived.load(std::memory_order_acquire) < 2 * threadCount)
+                {
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        std::sort(indexes.begin(), indexes.end());
+        unsigned int distinct = static_cast<unsigned int>(std::unique(indexes.begin(), indexes.end()) - indexes.begin());
+
+        return threadCount - distinct;
+    }
+
+
+    // Runs several generations of threads against the same lists, each
+    // generation larger than the last, reporting how many threads shared.
+    void checkShardAssignment(unsigned int shardCount)
+    {
+        ShardedList<unsigned int> list{shardCount};
+        ShardedList<unsigned int> other{shardCount};
+
+        std::printf("%u shards, live threads sharing a shard:", shardCount);
+
+        for (unsigned int round = 0; round < 3; round++)
+        {
+            for (unsigned int threadCount = 1; threadCount <= 2 * shardCount; threadCount++)
+            {
+                unsigned int shared = countSharedShards(list, other, threadCount);
+
+                // Every shard is in use before any thread shares one, so exactly the extra threads share.
+                require(shared == (threadCount > shardCount ? threadCount - shardCount : 0), "live threads shared a shard while others were free");
+
+                if (round == 2)
+                {
+                    std::printf(" %u:%u", threadCount, shared);
+                }
+            }
+        }
+
+        std::printf("\n");
+    }
+}
+
+
+
+int main()
+{
+    checkConcurrentDrain(appenderCount, 1);
+    checkConcurrentDrain(2, 1);
+    checkConcurrentDrain(appenderCount, 3);
+
+    checkShardAssignment(4);
+    checkShardAssignment(appenderCount);
+
+    return 0;
+}
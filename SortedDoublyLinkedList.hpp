@@ -0,0 +1,339 @@
+// SortedDoublyLinkedList.hpp
+// A DoublyLinkedList that keeps its values in sorted order.
+//
+// Finding where a value belongs in a linked list means walking to it, so
+// instead of always walking from the head, every search also starts from
+// a "finger": the node most recently inserted.  Comparing against the
+// finger tells which side of it the value belongs on, and the search then
+// walks inward from both ends of that side at once (from the finger and
+// from the head or tail), one node at a time from each, so it stops after
+// at most twice as many steps as there are nodes between the value's
+// place and whichever starting point is nearest.  Arrivals that are close
+// to the previous one (nearly-sorted data, such as deadlines or
+// timestamps) therefore only walk a few nodes, values that belong near
+// either end find their place from that end, and values that belong at
+// either end are placed in constant time.
+//
+// Values that compare equal stay in the order they were inserted.
+// All of the public member functions listed with "noexcept" in their
+// signature never throw exceptions.  The others leave the list unchanged
+// in the event that an exception has been thrown.
+
+
+#ifndef SORTEDDOUBLYLINKEDLIST_HPP
+#define SORTEDDOUBLYLINKEDLIST_HPP
+
+#include <functional>
+#include <utility>
+#include "DoublyLinkedList.hpp"
+
+
+
+template <typename ValueType, typename Compare = std::less<ValueType>>
+class SortedDoublyLinkedList
+{
+public:
+    using ConstIterator = typename DoublyLinkedList<ValueType>::ConstIterator;
+
+
+    // Initializes this list to be empty, ordering values with the given
+    // comparison (by default, with operator<).
+    explicit SortedDoublyLinkedList(const Compare& compare = Compare{});
+
+    // Initializes this list as a copy of an existing one.
+    SortedDoublyLinkedList(const SortedDoublyLinkedList& list);
+
+    // Initializes this list from an expiring one.
+    SortedDoublyLinkedList(SortedDoublyLinkedList&& list) noexcept;
+
+
+    // Replaces the contents of this list with a copy of the contents
+    // of an existing one.
+    SortedDoublyLinkedList& operator=(const SortedDoublyLinkedList& list);
+
+    // Replaces the contents of this list with the contents of an
+    // expiring one.
+    SortedDoublyLinkedList& operator=(SortedDoublyLinkedList&& list) noexcept;
+
+
+    // insertSorted() adds a value to the list after every value that
+    // does not come after it, keeping the list in sorted order.
+    void insertSorted(const ValueType& value);
+
+
+    // lowerBound() returns a ConstIterator referring to the first value
+    // that does not come before the given one, or in the "past end"
+    // position if there isn't one.
+    ConstIterator lowerBound(const ValueType& value) const;
+
+    // upperBound() returns a ConstIterator referring to the first value
+    // that comes after the given one, or in the "past end" position if
+    // there isn't one.
+    ConstIterator upperBound(const ValueType& value) const;
+
+
+    // removeFromStart() removes the smallest value from the list.  In the
+    // event that the list is empty, an EmptyException will be thrown.
+    void removeFromStart();
+
+    // removeFromEnd() removes the largest value from the list.  In the
+    // event that the list is empty, an EmptyException will be thrown.
+    void removeFromEnd();
+
+    // clear() removes every value from the list, leaving it empty.
+    void clear() noexcept;
+
+
+    // first() and last() return the smallest and largest values in the
+    // list.  In the event that the list is empty, an EmptyException will
+    // be thrown.  The values cannot be modified, since that could break
+    // the order of the list.
+    const ValueType& first() const;
+    const ValueType& last() const;
+
+
+    // isEmpty() returns true if the list has no values in it, false
+    // otherwise.
+    bool isEmpty() const noexcept;
+
+    // size() returns the number of values in the list.
+    unsigned int size() const noexcept;
+
+
+    // constIterator() creates a new ConstIterator over this list, referring
+    // to its smallest value.
+    ConstIterator constIterator() const;
+
+    // list() returns the underlying list, which is in sorted order, so
+    // that it can be read by anything that takes a DoublyLinkedList.
+    const DoublyLinkedList<ValueType>& list() const noexcept;
+
+
+private:
+    using Node = typename DoublyLinkedList<ValueType>::Node;
+
+    // Returns the first node that isBefore() is false for (or nullptr if
+    // it is true for every node), where isBefore() must be true for some
+    // prefix of the list and false for the rest.  The walk goes inward
+    // from both ends of the stretch between the finger and the head or
+    // tail that the boundary lies in (or of the whole list, when there is
+    // no finger).
+    template <typename IsBefore>
+    Node* findBoundary(IsBefore isBefore) const;
+
+
+    DoublyLinkedList<ValueType> values;
+    Compare compare;
+
+    // The most recently inserted node, or nullptr if it has been removed
+    // or nothing has been inserted.
+    Node* finger;
+};
+
+
+
+// Default constructor
+template <typename ValueType, typename Compare>
+SortedDoublyLinkedList<ValueType, Compare>::SortedDoublyLinkedList(const Compare& compare)
+    : values{}, compare{compare}, finger{nullptr}
+{
+}
+
+
+// Copy Constructor: the finger belongs to the other list, so start without one.
+template <typename ValueType, typename Compare>
+SortedDoublyLinkedList<ValueType, Compare>::SortedDoublyLinkedList(const SortedDoublyLinkedList& list)
+    : values{list.values}, compare{list.compare}, finger{nullptr}
+{
+}
+
+
+// Move constructor: the nodes (and therefore the finger) come along with the values.
+template <typename ValueType, typename Compare>
+SortedDoublyLinkedList<ValueType, Compare>::SortedDoublyLinkedList(SortedDoublyLinkedList&& list) noexcept
+    : values{std::move(list.values)}, compare{list.compare}, finger{list.finger}
+{
+    list.finger = nullptr;
+}
+
+
+// Assignment operator
+template <typename ValueType, typename Compare>
+SortedDoublyLinkedList<ValueType, Compare>& SortedDoublyLinkedList<ValueType, Compare>::operator=(const SortedDoublyLinkedList& list)
+{
+    if (this != &list)
+    {
+        values = list.values;
+        compare = list.compare;
+        finger = nullptr;
+    }
+    return *this;
+}
+
+
+// Move assignment operator: the lists swap nodes, so they swap fingers too.
+template <typename ValueType, typename Compare>
+SortedDoublyLinkedList<ValueType, Compare>& SortedDoublyLinkedList<ValueType, Compare>::operator=(SortedDoublyLinkedList&& list) noexcept
+{
+    if (this != &list)
+    {
+        values = std::move(list.values);
+        std::swap(compare, list.compare);
+        std::swap(finger, list.finger);
+    }
+    return *this;
+}
+
+
+// Inserts after the last value that doesn't come after it, and moves the finger there.
+template <typename ValueType, typename Compare>
+void SortedDoublyLinkedList<ValueType, Compare>::insertSorted(const ValueType& value)
+{
+    Node* position = findBoundary([this, &value](const Node* node) { return compare(value, node->value) == false; });
+
+    finger = values.insertNodeBefore(position, value);
+}
+
+
+template <typename ValueType, typename Compare>
+typename SortedDoublyLinkedList<ValueType, Compare>::ConstIterator SortedDoublyLinkedList<ValueType, Compare>::lowerBound(const ValueType& value) const
+{
+    return values.constIteratorAt(findBoundary([this, &value](const Node* node) { return compare(node->value, value); }));
+}
+
+
+template <typename ValueType, typename Compare>
+typename SortedDoublyLinkedList<ValueType, Compare>::ConstIterator SortedDoublyLinkedList<ValueType, Compare>::upperBound(const ValueType& value) const
+{
+    return values.constIteratorAt(findBoundary([this, &value](const Node* node) { return compare(value, node->value) == false; }));
+}
+
+
+// Removes the head, moving the finger off of it first if necessary.
+template <typename ValueType, typename Compare>
+void SortedDoublyLinkedList<ValueType, Compare>::removeFromStart()
+{
+    if (finger != nullptr && finger == values.head)
+    {
+        finger = finger->next;
+    }
+
+    values.removeFromStart();
+}
+
+
+// Removes the tail, moving the finger off of it first if necessary.
+template <typename ValueType, typename Compare>
+void SortedDoublyLinkedList<ValueType, Compare>::removeFromEnd()
+{
+    if (finger != nullptr && finger == values.tail)
+    {
+        finger = finger->prev;
+    }
+
+    values.removeFromEnd();
+}
+
+
+template <typename ValueType, typename Compare>
+void SortedDoublyLinkedList<ValueType, Compare>::clear() noexcept
+{
+    values.clear();
+    finger = nullptr;
+}
+
+
+template <typename ValueType, typename Compare>
+const ValueType& SortedDoublyLinkedList<ValueType, Compare>::first() const
+{
+    return values.first();
+}
+
+
+template <typename ValueType, typename Compare>
+const ValueType& SortedDoublyLinkedList<ValueType, Compare>::last() const
+{
+    return values.last();
+}
+
+
+template <typename ValueType, typename Compare>
+bool SortedDoublyLinkedList<ValueType, Compare>::isEmpty() const noexcept
+{
+    return values.isEmpty();
+}
+
+
+template <typename ValueType, typename Compare>
+unsigned int SortedDoublyLinkedList<ValueType, Compare>::size() const noexcept
+{
+    return values.size();
+}
+
+
+template <typename ValueType, typename Compare>
+typename SortedDoublyLinkedList<ValueType, Compare>::ConstIterator SortedDoublyLinkedList<ValueType, Compare>::constIterator() const
+{
+    return values.constIterator();
+}
+
+
+template <typename ValueType, typename Compare>
+const DoublyLinkedList<ValueType>& SortedDoublyLinkedList<ValueType, Compare>::list() const noexcept
+{
+    return values;
+}
+
+
+// Finger search: check both ends first, then narrow the boundary down to one side of the finger and
+// walk in from both ends of that side, so that the search ends as soon as either walk reaches it.
+template <typename ValueType, typename Compare>
+template <typename IsBefore>
+typename SortedDoublyLinkedList<ValueType, Compare>::Node* SortedDoublyLinkedList<ValueType, Compare>::findBoundary(IsBefore isBefore) const
+{
+    // Empty list, or everything is before the boundary (the common case for ascending arrivals).
+    if (values.tail == nullptr || isBefore(values.tail))
+    {
+        return nullptr;
+    }
+    // Nothing is before the boundary.
+    else if (isBefore(values.head) == false)
+    {
+        return values.head;
+    }
+
+    // From here on the boundary is strictly after the head and no later than the tail.  low is always a
+    // node before the boundary and high one that isn't, so the boundary is in (low, high].
+    Node* low = values.head;
+    Node* high = values.tail;
+
+    if (finger != nullptr && isBefore(finger))
+    {
+        low = finger;
+    }
+    else if (finger != nullptr)
+    {
+        high = finger;
+    }
+
+    // Both walks stop at the boundary at the latest, so neither can run off the list.
+    for (;;)
+    {
+        low = low->next;
+        if (isBefore(low) == false)
+        {
+            return low;
+        }
+
+        if (isBefore(high->prev))
+        {
+            return high;
+        }
+        high = high->prev;
+    }
+}
+
+
+
+#endif
+
@@ -0,0 +1,98 @@
+// SortedInsertBenchmark.cpp
+// Compares SortedDoublyLinkedList::insertSorted() with keeping a plain
+// DoublyLinkedList sorted by scanning from its head for the insertion
+// point, for values arriving in increasing order, nearly sorted (each at
+// most a few places out), and in random order.
+//
+//     g++ -std=c++17 -O2 SortedInsertBenchmark.cpp -o SortedInsertBenchmark
+//     ./SortedInsertBenchmark [values, default 20000]
+//
+// A linear scan is quadratic in the number of values for every pattern
+// except decreasing arrivals, so the default is kept small enough for it
+// to finish quickly.
+
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+#include "SortedDoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    // The way sorted lists were kept before SortedDoublyLinkedList.
+    void insertByScanning(DoublyLinkedList<long>& list, long value)
+    {
+        DoublyLinkedList<long>::Iterator iterator = list.iterator();
+
+        while (iterator.isPastEnd() == false && iterator.value() <= value)
+        {
+            iterator.moveToNext();
+        }
+
+        if (iterator.isPastEnd() == true)
+        {
+            list.addToEnd(value);
+        }
+        else
+        {
+            iterator.insertBefore(value);
+        }
+    }
+
+
+    void measure(const char* pattern, const std::vector<long>& arrivals)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        DoublyLinkedList<long> scanned;
+        for (long value : arrivals)
+        {
+            insertByScanning(scanned, value);
+        }
+        double scanning = secondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        SortedDoublyLinkedList<long> sorted;
+        for (long value : arrivals)
+        {
+            sorted.insertSorted(value);
+        }
+        double finger = secondsSince(start);
+
+        bool same = scanned == sorted.list();
+
+        std::printf("%-14s linear scan %9.1f ns/insert   insertSorted() %7.1f ns/insert   %6.0fx%s\n", pattern,
+            scanning / arrivals.size() * 1e9, finger / arrivals.size() * 1e9, scanning / finger, same == true ? "" : "  (lists differ!)");
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 20000);
+    std::mt19937 random{1};
+
+    std::vector<long> increasing(values);
+    std::vector<long> nearlySorted(values);
+    std::vector<long> shuffled(values);
+
+    for (unsigned long i = 0; i < values; i++)
+    {
+        increasing[i] = static_cast<long>(i);
+        nearlySorted[i] = static_cast<long>(i) + static_cast<long>(random() % 16);
+        shuffled[i] = static_cast<long>(random());
+    }
+
+    std::printf("%lu values\n", values);
+
+    measure("increasing", increasing);
+    measure("nearly sorted", nearlySorted);
+    measure("random", shuffled);
+
+    return 0;
+}
@@ -0,0 +1,107 @@
+// TeardownBenchmark.cpp
+// Measures how long it takes to empty a large list: with clear(), which
+// the destructor and copy assignment also use, and by removing its values
+// one at a time, with nodes on the heap and in huge pages.
+//
+//     g++ -std=c++17 -O2 TeardownBenchmark.cpp -o TeardownBenchmark
+//     ./TeardownBenchmark [values, default 50000000]
+//
+// First, a buffer of 100000 values is filled and emptied 100 times,
+// emptied with clear() and with clearKeepingNodes(), which lets each
+// refill reuse the nodes rather than allocating them again.  Then each
+// large list is built with buildScattered(), so that its nodes are
+// scattered the way they are in a long-lived program, and then
+// emptied in order.  clear() with huge pages hands every node back to the
+// pool in one step; the heap has to free them one at a time.
+
+
+#include <chrono>
+#include <cstdio>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    template <typename NodeStorage>
+    void measure(const char* name, unsigned long values)
+    {
+        using List = DoublyLinkedList<long, NodeStorage>;
+
+        List list;
+
+        buildScattered(list, values);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        list.clear();
+        double cleared = secondsSince(start);
+
+        buildScattered(list, values);
+        start = std::chrono::steady_clock::now();
+        while (list.isEmpty() == false)
+        {
+            list.removeFromStart();
+        }
+        double removed = secondsSince(start);
+
+        std::printf("%-9s clear() %7.3f s (%5.1f ns/value)   removeFromStart() loop %7.3f s (%5.1f ns/value)\n", name, cleared,
+            cleared / values * 1e9, removed, removed / values * 1e9);
+    }
+
+
+    // A batch buffer that is filled and emptied over and over, emptied with clear() or with
+    // clearKeepingNodes(), which lets every round after the first reuse the nodes.
+    template <typename NodeStorage>
+    void measureReset(const char* name, unsigned long batchSize)
+    {
+        using List = DoublyLinkedList<long, NodeStorage>;
+        constexpr int rounds = 100;
+
+        auto cycle = [batchSize](List& list, bool keepNodes)
+        {
+            for (int round = 0; round < rounds; round++)
+            {
+                for (unsigned long i = 0; i < batchSize; i++)
+                {
+                    list.addToEnd(static_cast<long>(i));
+                }
+
+                if (keepNodes == true)
+                {
+                    list.clearKeepingNodes();
+                }
+                else
+                {
+                    list.clear();
+                }
+            }
+        };
+
+        List freed;
+        List kept;
+        double freeing = bestOf(3, [&cycle, &freed] { cycle(freed, false); });
+        double keeping = bestOf(3, [&cycle, &kept] { cycle(kept, true); });
+
+        std::printf("%-9s fill and reset %lu values: clear() %5.1f ns/value   clearKeepingNodes() %5.1f ns/value\n", name, batchSize,
+            freeing / (rounds * batchSize) * 1e9, keeping / (rounds * batchSize) * 1e9);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 50000000);
+
+    std::printf("%lu values\n", values);
+
+    // The resets go first: once the pool has taken back a scattered list, it hands out
+    // scattered slots, and a buffer made of them misses the cache on every node.
+    measureReset<HeapNodeStorage>("heap", 100000);
+    measureReset<HugePageNodeStorage>("hugepage", 100000);
+
+    measure<HeapNodeStorage>("heap", values);
+    measure<HugePageNodeStorage>("hugepage", values);
+
+    return 0;
+}
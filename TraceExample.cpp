@@ -0,0 +1,95 @@
+// TraceExample.cpp
+// Records a small multi-threaded workload with DoublyLinkedList tracing
+// turned on, and writes it out as a Chrome trace.
+//
+//     g++ -std=c++17 -O2 -pthread TraceExample.cpp -o TraceExample
+//     ./TraceExample [output file, default list-trace.json]
+//
+// Open the output in chrome://tracing or ui.perfetto.dev to see one track
+// per thread, with a span for every add, remove and copy.  Four threads
+// each fill a ShardedList and their own local list, one thread drains
+// the ShardedList as it goes, and the main thread copies the result.
+
+
+#define DOUBLYLINKEDLIST_ENABLE_TRACING
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "DoublyLinkedList.hpp"
+#include "ShardedList.hpp"
+
+
+
+int main(int argc, char** argv)
+{
+    const char* outputFile = (argc > 1) ? argv[1] : "list-trace.json";
+
+    constexpr unsigned int workerCount = 4;
+    constexpr int valuesPerWorker = 2000;
+
+    ShardedList<int> shared{workerCount};
+    std::atomic<unsigned int> workersRunning{workerCount};
+    DoublyLinkedList<int> collected;
+
+    std::vector<std::thread> threads;
+
+    for (unsigned int worker = 0; worker < workerCount; worker++)
+    {
+        threads.emplace_back([&shared, &workersRunning]
+        {
+            DoublyLinkedList<int> local;
+
+            for (int i = 0; i < valuesPerWorker; i++)
+            {
+                shared.addToEnd(i);
+                local.addToEnd(i);
+
+                // Keep the local list short, so that removals show up alongside the adds.
+                if (local.size() > 16)
+                {
+                    local.removeFromStart();
+                }
+            }
+
+            workersRunning.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    threads.emplace_back([&shared, &workersRunning, &collected]
+    {
+        while (workersRunning.load(std::memory_order_acquire) > 0)
+        {
+            DoublyLinkedList<int> drained = shared.drainAll();
+            collected.spliceToEnd(drained);
+            std::this_thread::yield();
+        }
+    });
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    DoublyLinkedList<int> rest = shared.drainAll();
+    collected.spliceToEnd(rest);
+
+    DoublyLinkedList<int> copy{collected};
+    copy = collected;
+
+    // Every thread has finished by now, so the trace holds all of their spans.
+    std::ofstream out{outputFile};
+    writeChromeTrace(out);
+    out.close();
+
+    if (out.fail() == true)
+    {
+        std::fprintf(stderr, "TraceExample: couldn't write %s\n", outputFile);
+        return 1;
+    }
+
+    std::printf("%u values collected; trace written to %s\n", collected.size(), outputFile);
+    return 0;
+}
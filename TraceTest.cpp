@@ -0,0 +1,163 @@
+// TraceTest.cpp
+// Checks that a thread's trace ring can be read and cleared by other
+// threads while its owner keeps recording.
+//
+// One thread records spans into its ring as fast as it can, going around
+// the ring many times over, while another keeps reading every span in it
+// and now and then clears it.  Each span is recorded with a start and
+// duration that belong together, and a name chosen by the start, so a
+// span read half old and half new shows up as a mismatch.  Each read must
+// also see the spans in the order they were recorded, with none from
+// before the last clear.  Built with -fsanitize=thread, this also checks
+// that none of it is a data race.
+//
+//     g++ -std=c++17 -g -O1 -fsanitize=thread -pthread TraceTest.cpp -o TraceTest
+//     ./TraceTest
+//
+// The program prints each check as it passes, and aborts on the first one
+// that fails.
+
+
+#define DOUBLYLINKEDLIST_ENABLE_TRACING
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "DoublyLinkedList.hpp"
+
+
+
+namespace
+{
+    constexpr std::uint64_t spansRecorded = 8 * TraceRing::capacity;
+
+    const char* const evenName = "even";
+    const char* const oddName = "odd";
+
+
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "TraceTest: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    void checkConcurrentReads()
+    {
+        TraceRing ring{1};
+        std::atomic<std::uint64_t> recordedSoFar{0};
+        std::atomic<bool> recording{true};
+
+        std::thread owner{[&ring, &recordedSoFar, &recording]
+        {
+            for (std::uint64_t start = 1; start <= spansRecorded; start++)
+            {
+                ring.record((start % 2 == 0) ? evenName : oddName, start, 3 * start);
+                recordedSoFar.store(start, std::memory_order_release);
+            }
+
+            recording.store(false, std::memory_order_release);
+        }};
+
+        unsigned long reads = 0;
+        unsigned long spansRead = 0;
+
+        while (recording.load(std::memory_order_acquire) == true)
+        {
+            // Every span recorded before a clear is gone from reads that start after it.
+            bool clearing = (reads % 8 == 7);
+            std::uint64_t clearedBefore = recordedSoFar.load(std::memory_order_acquire);
+
+            if (clearing == true)
+            {
+                ring.clear();
+            }
+
+            std::uint64_t previous = 0;
+
+            ring.forEachSpan([&previous, &spansRead, clearing, clearedBefore](const TraceRing::Span& span)
+            {
+                require(span.durationNanoseconds == 3 * span.startNanoseconds, "a span was read half overwritten");
+                require(span.name == ((span.startNanoseconds % 2 == 0) ? evenName : oddName), "a span has the wrong name");
+                require(span.startNanoseconds > previous, "spans came out of order");
+                require(clearing == false || span.startNanoseconds > clearedBefore, "a cleared span was read");
+
+                previous = span.startNanoseconds;
+                spansRead++;
+            });
+
+            reads++;
+        }
+
+        owner.join();
+
+        // With the owner finished, a read sees every span from the last clear (or the oldest one the ring
+        // still holds) to the newest, with none missing.
+        std::uint64_t expected = 0;
+        ring.forEachSpan([&expected](const TraceRing::Span& span)
+        {
+            require(expected == 0 || span.startNanoseconds == expected, "a span is missing once recording has stopped");
+            require(span.startNanoseconds > spansRecorded - TraceRing::capacity, "a span that should have been overwritten");
+            expected = span.startNanoseconds + 1;
+        });
+        require(expected == 0 || expected == spansRecorded + 1, "the ring doesn't end with the newest span");
+
+        ring.clear();
+        bool any = false;
+        ring.forEachSpan([&any](const TraceRing::Span&) { any = true; });
+        require(any == false, "clear() left spans behind");
+
+        std::printf("%lu reads of %lu spans while recording: passed\n", reads, spansRead);
+    }
+
+
+    // The lists' own trace points, written out while other threads are still adding.
+    void checkWriteWhileTracing()
+    {
+        std::atomic<bool> running{true};
+        std::thread adder{[&running]
+        {
+            DoublyLinkedList<int> list;
+
+            while (running.load(std::memory_order_acquire) == true)
+            {
+                list.addToEnd(1);
+                list.removeFromStart();
+            }
+        }};
+
+        for (int i = 0; i < 20; i++)
+        {
+            std::ostringstream out;
+            writeChromeTrace(out);
+            require(out.str().find("\"traceEvents\"") != std::string::npos, "the trace wasn't written");
+
+            if (i % 5 == 4)
+            {
+                clearTrace();
+            }
+        }
+
+        running.store(false, std::memory_order_release);
+        adder.join();
+
+        std::printf("writeChromeTrace() and clearTrace() while tracing: passed\n");
+    }
+}
+
+
+
+int main()
+{
+    checkConcurrentReads();
+    checkWriteWhileTracing();
+
+    return 0;
+}
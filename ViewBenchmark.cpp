@@ -0,0 +1,114 @@
+// ViewBenchmark.cpp
+// Compares a three-step pipeline (filter, transform, take) run as a lazy
+// view with the same pipeline run eagerly, building a list per step, for
+// time and for the peak memory taken by list nodes.
+//
+//     g++ -std=c++17 -O2 ViewBenchmark.cpp -o ViewBenchmark
+//     ./ViewBenchmark [values, default 10000000]
+//
+// Peak memory is measured with a CountingMemoryTracker, from just before
+// the pipeline runs, so it counts the nodes of the intermediate lists and
+// of the result but not those of the source list.
+
+
+#include <cstdio>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+#include "DoublyLinkedListView.hpp"
+#include "MemoryTracking.hpp"
+
+
+
+namespace
+{
+    CountingMemoryTracker tracker;
+
+
+    bool isKept(long value)
+    {
+        return value % 3 != 0;
+    }
+
+
+    long transformed(long value)
+    {
+        return value * value + 1;
+    }
+
+
+    // Each step walks the previous step's list and builds a new one, as code did before views.
+    DoublyLinkedList<long> eager(const DoublyLinkedList<long>& source, unsigned int limit)
+    {
+        DoublyLinkedList<long> filtered;
+        source.forEach([&filtered](long value)
+        {
+            if (isKept(value) == true)
+            {
+                filtered.addToEnd(value);
+            }
+        });
+
+        DoublyLinkedList<long> mapped;
+        filtered.forEach([&mapped](long value) { mapped.addToEnd(transformed(value)); });
+
+        DoublyLinkedList<long> taken;
+        for (DoublyLinkedList<long>::ConstIterator iterator = mapped.constIterator();
+            iterator.isPastEnd() == false && taken.size() < limit; iterator.moveToNext())
+        {
+            taken.addToEnd(iterator.value());
+        }
+
+        return taken;
+    }
+
+
+    DoublyLinkedList<long> lazy(const DoublyLinkedList<long>& source, unsigned int limit)
+    {
+        return view(source).filter(isKept).transform(transformed).take(limit).collect();
+    }
+
+
+    // Runs a pipeline a few times, reporting its best time and its peak node memory.
+    template <typename Pipeline>
+    void measure(const char* name, const DoublyLinkedList<long>& source, unsigned int limit, Pipeline pipeline)
+    {
+        std::size_t peak = 0;
+        long check = 0;
+
+        double best = bestOf(3, [&source, limit, &pipeline, &peak, &check]
+        {
+            std::size_t before = tracker.bytesInUse.load();
+            tracker.peakBytes.store(before);
+
+            DoublyLinkedList<long> result = pipeline(source, limit);
+
+            peak = tracker.peakBytes.load() - before;
+            check = result.last();
+        });
+
+        std::printf("%-6s %7.3f s  peak %8.1f MB of nodes  (last value %ld)\n", name, best, peak / 1e6, check);
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 10000000);
+    unsigned int limit = static_cast<unsigned int>(values / 2);
+
+    DoublyLinkedList<long> source;
+    for (unsigned long i = 0; i < values; i++)
+    {
+        source.addToEnd(static_cast<long>(i));
+    }
+
+    setMemoryTracker(&tracker);
+
+    std::printf("%lu values, keeping %u\n", values, limit);
+    measure("eager", source, limit, eager);
+    measure("view", source, limit, lazy);
+
+    setMemoryTracker(nullptr);
+    return 0;
+}
@@ -0,0 +1,483 @@
+// WindowedList.hpp
+// A DoublyLinkedList used as a sliding window, which keeps aggregates of
+// the values in it (such as their minimum or mean) up to date as values
+// are added to the end and removed from the start, so that reading one
+// never requires walking the window.
+//
+// The aggregates to keep are given as template arguments after the value
+// type, for example
+//
+//     WindowedList<double, MinAggregate<double>, MeanAggregate<double>> window;
+//     window.addToEnd(sample);
+//     double lowest = window.aggregate<MinAggregate<double>>();
+//
+// Each aggregate is a class that is default constructible (as the
+// aggregate of an empty window) and provides
+//
+//     void added(const ValueType& value);
+//     void unadded(const ValueType& value);
+//     void removed(const ValueType& value);
+//     SomeType value() const;
+//
+// where added() is called for each value added to the end of the window,
+// and must leave the aggregate unchanged if it throws; unadded() takes
+// back the most recent call to added(), in case adding the value to
+// another aggregate fails; removed() is called for each value removed
+// from the start of the window; and value() returns the aggregate.
+// unadded() and removed() aren't noexcept, since they compare and convert
+// values, which can throw for some value types and comparisons; the
+// aggregates here throw from nothing else.
+//
+// MinAggregate and MaxAggregate keep a "monotonic deque": the values that
+// could still become the minimum (or maximum) once the values before them
+// leave the window, in the order they arrived.  Each value is added to it
+// once and removed from it at most once, so they take constant amortized
+// time per value.  SumAggregate, MeanAggregate and VarianceAggregate keep
+// running totals, and take constant time.
+//
+// All of the public member functions listed with "noexcept" in their
+// signature never throw exceptions.  The others leave the window and its
+// aggregates unchanged in the event that an exception has been thrown,
+// as long as the aggregates' unadded() and removed() don't throw.  If
+// they do, the window's values are still unchanged, but its aggregates
+// may not match them until clear() is called.
+
+
+#ifndef WINDOWEDLIST_HPP
+#define WINDOWEDLIST_HPP
+
+#include <cstddef>
+#include <functional>
+#include <tuple>
+#include <utility>
+#include "DoublyLinkedList.hpp"
+#include "EmptyException.hpp"
+
+
+
+// The minimum (or, with a different comparison, maximum) of the window:
+// the value that no other value in the window comes before.  value()
+// throws an EmptyException when the window is empty.
+template <typename ValueType, typename Compare = std::less<ValueType>>
+class MinAggregate
+{
+public:
+    // Adding a value never allocates more than its own node, which comes first
+    // so that nothing has changed if it throws.  Settling the value before it
+    // only drops candidates that can never be the minimum, so it isn't a
+    // visible change.
+    void added(const ValueType& value)
+    {
+        settleLast();
+
+        candidates.addToEnd(value);
+        lastSettled = false;
+    }
+
+
+    // The last candidate hasn't been settled, so removing it puts things back
+    // exactly as they were.
+    void unadded(const ValueType&)
+    {
+        candidates.removeFromEnd();
+        lastSettled = true;
+    }
+
+
+    // The oldest value is a candidate unless a later value that comes before it
+    // has already displaced it; if it is one, it is the first.
+    void removed(const ValueType& value)
+    {
+        settleLast();
+
+        if (compare(candidates.first(), value) == false && compare(value, candidates.first()) == false)
+        {
+            candidates.removeFromStart();
+        }
+    }
+
+
+    // Every settled candidate comes after the ones before it, so the minimum is
+    // either the first candidate or the unsettled last one.
+    const ValueType& value() const
+    {
+        if (candidates.isEmpty() == true)
+        {
+            throw EmptyException{};
+        }
+        else if (lastSettled == false && compare(candidates.last(), candidates.first()) == true)
+        {
+            return candidates.last();
+        }
+        else
+        {
+            return candidates.first();
+        }
+    }
+
+
+private:
+    // Removes the candidates before the last one that the last one comes
+    // before, since they leave the window before it does.  Equal values are
+    // kept, so that each one can be matched when it leaves.
+    void settleLast()
+    {
+        if (lastSettled == true)
+        {
+            return;
+        }
+
+        const ValueType& lastValue = candidates.last();
+        typename DoublyLinkedList<ValueType>::Iterator iterator = candidates.iteratorAtEnd();
+        iterator.moveToPrevious();
+
+        while (iterator.isPastStart() == false && compare(lastValue, iterator.value()) == true)
+        {
+            iterator.remove(false);
+        }
+
+        lastSettled = true;
+    }
+
+
+    DoublyLinkedList<ValueType> candidates;
+    bool lastSettled = true;
+    Compare compare;
+};
+
+
+// The maximum of the window.  value() throws an EmptyException when the
+// window is empty.
+template <typename ValueType>
+using MaxAggregate = MinAggregate<ValueType, std::greater<ValueType>>;
+
+
+
+// The sum of the values in the window, accumulated as SumType (by default,
+// the value type itself), which is 0 when the window is empty.
+template <typename ValueType, typename SumType = ValueType>
+class SumAggregate
+{
+public:
+    void added(const ValueType& value)
+    {
+        sum += static_cast<SumType>(value);
+    }
+
+
+    void unadded(const ValueType& value)
+    {
+        sum -= static_cast<SumType>(value);
+    }
+
+
+    void removed(const ValueType& value)
+    {
+        sum -= static_cast<SumType>(value);
+    }
+
+
+    SumType value() const noexcept
+    {
+        return sum;
+    }
+
+
+private:
+    SumType sum{};
+};
+
+
+
+// The mean of the values in the window.  value() throws an EmptyException
+// when the window is empty.
+template <typename ValueType>
+class MeanAggregate
+{
+public:
+    void added(const ValueType& value)
+    {
+        sum += static_cast<double>(value);
+        count++;
+    }
+
+
+    void unadded(const ValueType& value)
+    {
+        removed(value);
+    }
+
+
+    // Starting again from exactly 0 whenever the window empties stops rounding
+    // errors from carrying over.
+    void removed(const ValueType& value)
+    {
+        double x = static_cast<double>(value);
+
+        count--;
+        sum = (count == 0) ? 0.0 : sum - x;
+    }
+
+
+    double value() const
+    {
+        if (count == 0)
+        {
+            throw EmptyException{};
+        }
+
+        return sum / count;
+    }
+
+
+private:
+    double sum = 0.0;
+    unsigned int count = 0;
+};
+
+
+
+// The population variance of the values in the window (the mean squared
+// distance from their mean).  value() throws an EmptyException when the
+// window is empty.
+//
+// Rather than subtracting the square of the mean from the mean of the
+// squares, which loses most of its precision when the values are large
+// compared to their spread, this keeps the running mean and sum of squared
+// distances from it (Welford's method), which can be updated both ways.
+template <typename ValueType>
+class VarianceAggregate
+{
+public:
+    void added(const ValueType& value)
+    {
+        double x = static_cast<double>(value);
+        double distance = x - mean;
+
+        count++;
+        mean += distance / count;
+        squaredDistances += distance * (x - mean);
+    }
+
+
+    void unadded(const ValueType& value)
+    {
+        removed(value);
+    }
+
+
+    // The same steps as added(), undone in reverse order.
+    void removed(const ValueType& value)
+    {
+        double x = static_cast<double>(value);
+
+        count--;
+
+        if (count == 0)
+        {
+            mean = 0.0;
+            squaredDistances = 0.0;
+            return;
+        }
+
+        double distance = x - mean;
+
+        mean -= distance / count;
+        squaredDistances -= distance * (x - mean);
+
+        // Rounding can leave a tiny negative total when the remaining values are all equal.
+        if (squaredDistances < 0.0)
+        {
+            squaredDistances = 0.0;
+        }
+    }
+
+
+    double value() const
+    {
+        if (count == 0)
+        {
+            throw EmptyException{};
+        }
+
+        return squaredDistances / count;
+    }
+
+
+private:
+    double mean = 0.0;
+    double squaredDistances = 0.0;
+    unsigned int count = 0;
+};
+
+
+
+template <typename ValueType, typename... Aggregates>
+class WindowedList
+{
+public:
+    using ConstIterator = typename DoublyLinkedList<ValueType>::ConstIterator;
+
+
+    // Initializes this window to be empty.
+    WindowedList() = default;
+
+
+    // addToEnd() adds a value to the end of the window and to every
+    // aggregate.
+    void addToEnd(const ValueType& value);
+
+    // removeFromStart() removes the value at the start of the window, and
+    // from every aggregate.  In the event that the window is empty, an
+    // EmptyException will be thrown.
+    void removeFromStart();
+
+    // clear() removes every value from the window, and resets every
+    // aggregate to that of an empty window.
+    void clear();
+
+
+    // aggregate() returns the value of one of the window's aggregates,
+    // chosen by its type, without walking the window.
+    template <typename Aggregate>
+    decltype(auto) aggregate() const;
+
+
+    // first() and last() return the oldest and newest values in the
+    // window.  In the event that the window is empty, an EmptyException
+    // will be thrown.  The values cannot be modified, since that would
+    // leave the aggregates out of date.
+    const ValueType& first() const;
+    const ValueType& last() const;
+
+
+    // isEmpty() returns true if the window has no values in it, false
+    // otherwise.
+    bool isEmpty() const noexcept;
+
+    // size() returns the number of values in the window.
+    unsigned int size() const noexcept;
+
+
+    // constIterator() creates a new ConstIterator over this window,
+    // referring to its oldest value.
+    ConstIterator constIterator() const;
+
+    // list() returns the values in the window, oldest first, so that they
+    // can be read by anything that takes a DoublyLinkedList.
+    const DoublyLinkedList<ValueType>& list() const noexcept;
+
+
+private:
+    DoublyLinkedList<ValueType> values;
+    std::tuple<Aggregates...> aggregates;
+};
+
+
+
+// Adds to the window first, then to each aggregate in turn; if one fails, the ones already
+// updated are taken back before the value comes off the window again.
+template <typename ValueType, typename... Aggregates>
+void WindowedList<ValueType, Aggregates...>::addToEnd(const ValueType& value)
+{
+    values.addToEnd(value);
+
+    std::size_t addedCount = 0;
+
+    try
+    {
+        std::apply([&value, &addedCount](Aggregates&... each) { ((each.added(value), addedCount++), ...); }, aggregates);
+    }
+    catch(...)
+    {
+        std::apply([&value, addedCount](Aggregates&... each)
+        {
+            std::size_t index = 0;
+            ((index++ < addedCount ? each.unadded(value) : void()), ...);
+        }, aggregates);
+
+        values.removeFromEnd();
+        throw;
+    }
+}
+
+
+// The aggregates see the value before it is destroyed.
+template <typename ValueType, typename... Aggregates>
+void WindowedList<ValueType, Aggregates...>::removeFromStart()
+{
+    if (values.isEmpty() == true)
+    {
+        throw EmptyException{};
+    }
+
+    const ValueType& value = values.first();
+    std::apply([&value](Aggregates&... each) { (each.removed(value), ...); }, aggregates);
+
+    values.removeFromStart();
+}
+
+
+// The fresh aggregates are built first, so that nothing has changed if that throws.
+template <typename ValueType, typename... Aggregates>
+void WindowedList<ValueType, Aggregates...>::clear()
+{
+    std::tuple<Aggregates...> emptyAggregates{};
+
+    values.clear();
+    aggregates = std::move(emptyAggregates);
+}
+
+
+template <typename ValueType, typename... Aggregates>
+template <typename Aggregate>
+decltype(auto) WindowedList<ValueType, Aggregates...>::aggregate() const
+{
+    return std::get<Aggregate>(aggregates).value();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+const ValueType& WindowedList<ValueType, Aggregates...>::first() const
+{
+    return values.first();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+const ValueType& WindowedList<ValueType, Aggregates...>::last() const
+{
+    return values.last();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+bool WindowedList<ValueType, Aggregates...>::isEmpty() const noexcept
+{
+    return values.isEmpty();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+unsigned int WindowedList<ValueType, Aggregates...>::size() const noexcept
+{
+    return values.size();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+typename WindowedList<ValueType, Aggregates...>::ConstIterator WindowedList<ValueType, Aggregates...>::constIterator() const
+{
+    return values.constIterator();
+}
+
+
+template <typename ValueType, typename... Aggregates>
+const DoublyLinkedList<ValueType>& WindowedList<ValueType, Aggregates...>::list() const noexcept
+{
+    return values;
+}
+
+
+
+#endif
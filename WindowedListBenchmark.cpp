@@ -0,0 +1,99 @@
+// WindowedListBenchmark.cpp
+// Compares keeping the minimum, maximum and mean of a sliding window with
+// WindowedList against recomputing them by walking the window after
+// every step, for windows of 1000 to 1000000 values.
+//
+//     g++ -std=c++17 -O2 WindowedListBenchmark.cpp -o WindowedListBenchmark
+//     ./WindowedListBenchmark
+//
+// Each step adds a random sample to the end of the window, removes the
+// oldest one and reads all three aggregates.  The window is filled before
+// timing starts.  A rescan costs time in proportion to the window, so
+// fewer steps are timed for larger windows.
+
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+#include "WindowedList.hpp"
+
+
+
+namespace
+{
+    void measure(unsigned int windowSize)
+    {
+        unsigned int steps = 100000000 / windowSize;
+        steps = (steps < 100) ? 100 : (steps > 1000000 ? 1000000 : steps);
+
+        std::mt19937 random{1};
+        WindowedList<double, MinAggregate<double>, MaxAggregate<double>, MeanAggregate<double>> window;
+        DoublyLinkedList<double> plain;
+
+        for (unsigned int i = 0; i < windowSize; i++)
+        {
+            double sample = static_cast<double>(random() % 1000000);
+            window.addToEnd(sample);
+            plain.addToEnd(sample);
+        }
+
+        std::mt19937 samples{2};
+        double rescanCheck = 0.0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned int step = 0; step < steps; step++)
+        {
+            plain.removeFromStart();
+            plain.addToEnd(static_cast<double>(samples() % 1000000));
+
+            double lowest = plain.first();
+            double highest = plain.first();
+            double sum = 0.0;
+
+            plain.forEach([&lowest, &highest, &sum](double value)
+            {
+                lowest = (value < lowest) ? value : lowest;
+                highest = (value > highest) ? value : highest;
+                sum += value;
+            });
+
+            rescanCheck += lowest + highest + sum / plain.size();
+        }
+        double rescan = secondsSince(start) / steps;
+
+        samples.seed(2);
+        double windowCheck = 0.0;
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned int step = 0; step < steps; step++)
+        {
+            window.removeFromStart();
+            window.addToEnd(static_cast<double>(samples() % 1000000));
+
+            windowCheck += window.aggregate<MinAggregate<double>>() + window.aggregate<MaxAggregate<double>>()
+                + window.aggregate<MeanAggregate<double>>();
+        }
+        double windowed = secondsSince(start) / steps;
+
+        // The means are summed in different orders, so allow for rounding.
+        double difference = rescanCheck - windowCheck;
+        bool same = (difference < 0 ? -difference : difference) <= 1e-6 * (rescanCheck < 0 ? -rescanCheck : rescanCheck);
+
+        std::printf("window %7u   rescan %11.1f ns/step   WindowedList %6.1f ns/step   %8.0fx%s\n", windowSize, rescan * 1e9,
+            windowed * 1e9, rescan / windowed, same == true ? "" : "  (aggregates differ!)");
+    }
+}
+
+
+
+int main()
+{
+    for (unsigned int windowSize = 1000; windowSize <= 1000000; windowSize *= 10)
+    {
+        measure(windowSize);
+    }
+
+    return 0;
+}
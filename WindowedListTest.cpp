@@ -0,0 +1,257 @@
+// WindowedListTest.cpp
+// Checks WindowedList's aggregates against a rescan of the window.
+//
+// Random windows are slid over random values (with plenty of repeats, so
+// that equal minimums and maximums have to be matched as they leave),
+// growing and shrinking as they go, and after every step the minimum,
+// maximum, sum, mean and variance must match the ones computed by walking
+// the window from scratch.  Also checks that an aggregate throwing from
+// added() leaves everything as it was, and that a comparison throwing
+// from removed() reaches the caller rather than ending the program.
+//
+//     g++ -std=c++17 -g -fsanitize=address,undefined WindowedListTest.cpp -o WindowedListTest
+//     ./WindowedListTest
+//
+// The program prints each check as it passes, and aborts on the first one
+// that fails.
+
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include "WindowedList.hpp"
+
+
+
+namespace
+{
+    void require(bool condition, const char* what)
+    {
+        if (condition == false)
+        {
+            std::fprintf(stderr, "WindowedListTest: %s\n", what);
+            std::abort();
+        }
+    }
+
+
+    // Doubles computed in a different order can differ in their last bits.
+    bool close(double a, double b, double scale)
+    {
+        return std::fabs(a - b) <= 1e-9 * (scale > 1.0 ? scale : 1.0);
+    }
+
+
+    // Recomputes every aggregate of the window by walking it, and compares.
+    template <typename Window>
+    void requireMatchesRescan(const Window& window, const char* what)
+    {
+        if (window.isEmpty() == true)
+        {
+            require(window.template aggregate<SumAggregate<long>>() == 0, what);
+            return;
+        }
+
+        long minimum = window.first();
+        long maximum = window.first();
+        long sum = 0;
+        unsigned int count = 0;
+
+        window.list().forEach([&minimum, &maximum, &sum, &count](long value)
+        {
+            minimum = (value < minimum) ? value : minimum;
+            maximum = (value > maximum) ? value : maximum;
+            sum += value;
+            count++;
+        });
+
+        double mean = static_cast<double>(sum) / count;
+        double squaredDistances = 0.0;
+
+        window.list().forEach([mean, &squaredDistances](long value)
+        {
+            squaredDistances += (value - mean) * (value - mean);
+        });
+
+        double variance = squaredDistances / count;
+
+        require(count == window.size(), what);
+        require(window.template aggregate<MinAggregate<long>>() == minimum, what);
+        require(window.template aggregate<MaxAggregate<long>>() == maximum, what);
+        require(window.template aggregate<SumAggregate<long>>() == sum, what);
+        require(close(window.template aggregate<MeanAggregate<long>>(), mean, std::fabs(mean)), what);
+        require(close(window.template aggregate<VarianceAggregate<long>>(), variance, variance + mean * mean), what);
+    }
+
+
+    using Window = WindowedList<long, MinAggregate<long>, MaxAggregate<long>, SumAggregate<long>, MeanAggregate<long>,
+        VarianceAggregate<long>>;
+
+
+    // Slides windows whose size wanders around a random target over values
+    // drawn from a random range, checking after every step.
+    void checkRandomWindows()
+    {
+        std::mt19937 random{1};
+        unsigned long steps = 0;
+
+        for (int round = 0; round < 200; round++)
+        {
+            Window window;
+            unsigned int target = 1 + random() % 64;
+            long range = 1 + static_cast<long>(random() % 1000);
+            long offset = static_cast<long>(random() % 2000000) - 1000000;
+
+            for (int step = 0; step < 2000; step++)
+            {
+                // Usually hold the window near its target, but sometimes run it dry or let it grow.
+                bool add = (window.size() < target) ? (random() % 8 != 0) : (random() % 8 == 0);
+
+                if (add == true || window.isEmpty() == true)
+                {
+                    window.addToEnd(offset + static_cast<long>(random() % range));
+                }
+                else
+                {
+                    window.removeFromStart();
+                }
+
+                requireMatchesRescan(window, "an aggregate differs from a rescan");
+                steps++;
+            }
+
+            if (round % 10 == 0)
+            {
+                window.clear();
+                requireMatchesRescan(window, "an aggregate isn't reset by clear()");
+            }
+        }
+
+        std::printf("random windows, %lu steps: passed\n", steps);
+    }
+
+
+    // An aggregate whose added() throws for one value, after the ones before
+    // it in the window's list have already taken it.
+    class RefusingAggregate
+    {
+    public:
+        void added(const long& value)
+        {
+            if (value == refused)
+            {
+                throw EmptyException{};
+            }
+        }
+
+        void unadded(const long&)
+        {
+        }
+
+        void removed(const long&)
+        {
+        }
+
+        int value() const noexcept
+        {
+            return 0;
+        }
+
+        static constexpr long refused = 13;
+    };
+
+
+    void checkAddRollback()
+    {
+        WindowedList<long, MinAggregate<long>, MaxAggregate<long>, SumAggregate<long>, MeanAggregate<long>,
+            VarianceAggregate<long>, RefusingAggregate> window;
+
+        for (long value : {20, 5, 20, 30, 5})
+        {
+            window.addToEnd(value);
+        }
+
+        bool thrown = false;
+        try
+        {
+            window.addToEnd(RefusingAggregate::refused);
+        }
+        catch(EmptyException&)
+        {
+            thrown = true;
+        }
+
+        require(thrown == true && window.size() == 5 && window.last() == 5, "a failed add changed the window");
+        require(window.aggregate<MinAggregate<long>>() == 5 && window.aggregate<MaxAggregate<long>>() == 30, "a failed add changed the extremes");
+        require(window.aggregate<SumAggregate<long>>() == 80, "a failed add changed the sum");
+
+        window.removeFromStart();
+        window.removeFromStart();
+        window.addToEnd(1);
+        require(window.aggregate<MinAggregate<long>>() == 1 && window.aggregate<MaxAggregate<long>>() == 30, "extremes are wrong after a failed add");
+        require(close(window.aggregate<MeanAggregate<long>>(), 14.0, 14.0), "the mean is wrong after a failed add");
+
+        std::printf("rollback of a failed add: passed\n");
+    }
+
+
+    // A comparison that throws while failing is set, as a user-supplied one might.
+    bool failing = false;
+
+    struct FallibleLess
+    {
+        bool operator()(long a, long b) const
+        {
+            if (failing == true)
+            {
+                throw EmptyException{};
+            }
+
+            return a < b;
+        }
+    };
+
+
+    void checkThrowingCompare()
+    {
+        WindowedList<long, MinAggregate<long, FallibleLess>> window;
+
+        window.addToEnd(3);
+        window.addToEnd(1);
+        window.addToEnd(2);
+
+        failing = true;
+        bool thrown = false;
+        try
+        {
+            window.removeFromStart();
+        }
+        catch(EmptyException&)
+        {
+            thrown = true;
+        }
+        failing = false;
+
+        require(thrown == true && window.size() == 3 && window.first() == 3, "a throwing comparison didn't reach the caller");
+
+        window.clear();
+        window.addToEnd(4);
+        window.addToEnd(2);
+        require(window.aggregate<MinAggregate<long, FallibleLess>>() == 2, "clear() didn't put the aggregates right");
+
+        std::printf("throwing comparison in removed(): passed\n");
+    }
+}
+
+
+
+int main()
+{
+    checkRandomWindows();
+    checkAddRollback();
+    checkThrowingCompare();
+
+    return 0;
+}
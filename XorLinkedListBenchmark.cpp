@@ -0,0 +1,128 @@
+// XorLinkedListBenchmark.cpp
+// Compares the memory per value and the scan speed of XorLinkedList<int>
+// with those of DoublyLinkedList<int>, with nodes on the heap and in huge
+// pages.
+//
+//     g++ -std=c++17 -O2 XorLinkedListBenchmark.cpp -o XorLinkedListBenchmark
+//     ./XorLinkedListBenchmark [values, default 100000000]
+//
+// Each list is built and measured in a child process of its own, so that
+// memory freed by one doesn't get reused by the next and hide its cost.
+// Memory is reported twice: the bytes of the nodes themselves, from
+// memoryFootprint(), and how much the process's resident memory actually
+// grew, which also includes whatever the allocator adds to each node.
+// Building 100 million DoublyLinkedList nodes on the heap needs a little
+// over 3GB.
+
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "BenchmarkUtil.hpp"
+#include "DoublyLinkedList.hpp"
+#include "XorLinkedList.hpp"
+
+
+
+namespace
+{
+    // The process's resident memory, in bytes.
+    double residentBytes()
+    {
+        std::ifstream statm{"/proc/self/statm"};
+        unsigned long totalPages = 0;
+        unsigned long residentPages = 0;
+
+        statm >> totalPages >> residentPages;
+        return static_cast<double>(residentPages) * sysconf(_SC_PAGESIZE);
+    }
+
+
+    // Walks from the last value to the first with a ConstIterator.
+    template <typename List>
+    long reverseSum(const List& list)
+    {
+        long sum = 0;
+
+        for (typename List::ConstIterator iterator = list.constIteratorAtEnd(); iterator.isPastStart() == false; iterator.moveToPrevious())
+        {
+            sum += iterator.value();
+        }
+
+        return sum;
+    }
+
+
+    template <typename List>
+    void measure(const char* name, unsigned long values)
+    {
+        double residentBefore = residentBytes();
+
+        List list;
+        for (unsigned long i = 0; i < values; i++)
+        {
+            list.addToEnd(static_cast<int>(i));
+        }
+
+        double residentGrowth = residentBytes() - residentBefore;
+        double nodeBytes = static_cast<double>(list.memoryFootprint().nodeBytes);
+
+        long forwardSum = 0;
+        long backwardSum = 0;
+
+        double forward = bestOf(3, [&list, &forwardSum]
+        {
+            forwardSum = 0;
+            list.forEach([&forwardSum](int value) { forwardSum += value; });
+        });
+
+        double reverse = bestOf(3, [&list, &backwardSum] { backwardSum = reverseSum(list); });
+        long sum = backwardSum - forwardSum;
+
+        std::printf("%-34s %5.1f node bytes/value  %5.1f resident bytes/value  forward %7.1f M/s  reverse %7.1f M/s%s\n", name,
+            nodeBytes / values, residentGrowth / values, values / forward / 1e6, values / reverse / 1e6,
+            sum == 0 ? "" : "  (sums differ!)");
+    }
+
+
+    // Runs one measurement in a child process, so that it starts from a fresh heap.
+    template <typename List>
+    void measureInChild(const char* name, unsigned long values)
+    {
+        std::fflush(stdout);
+
+        pid_t child = fork();
+
+        if (child == 0)
+        {
+            measure<List>(name, values);
+            std::fflush(stdout);
+            _exit(0);
+        }
+
+        int status = 0;
+        waitpid(child, &status, 0);
+
+        if (WIFEXITED(status) == false || WEXITSTATUS(status) != 0)
+        {
+            std::printf("%-34s failed (out of memory?)\n", name);
+        }
+    }
+}
+
+
+
+int main(int argc, char** argv)
+{
+    unsigned long values = argumentOr(argc, argv, 1, 100000000);
+
+    std::printf("%lu values\n", values);
+
+    measureInChild<DoublyLinkedList<int>>("DoublyLinkedList<int>, heap", values);
+    measureInChild<XorLinkedList<int>>("XorLinkedList<int>, heap", values);
+    measureInChild<DoublyLinkedList<int, HugePageNodeStorage>>("DoublyLinkedList<int>, huge pages", values);
+    measureInChild<XorLinkedList<int, HugePageNodeStorage>>("XorLinkedList<int>, huge pages", values);
+
+    return 0;
+}